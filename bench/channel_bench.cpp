@@ -0,0 +1,116 @@
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "executor/channel.h"
+#include "executor/spsc_channel.h"
+#include "harness.h"
+
+namespace btft::bench {
+
+namespace {
+
+using interpreter::executor::Channel;
+using interpreter::executor::SpscChannel;
+
+// One producer thread writes `Iterations()` chunks of `chunk_size` bytes,
+// the calling thread reads them back until the channel is closed
+template <typename ChannelType>
+void ChannelThroughput(State &state, std::size_t chunk_size) {
+    auto channel = std::make_shared<ChannelType>();
+    const std::string chunk(chunk_size, 'x');
+
+    std::thread producer([&channel, &chunk, n = state.Iterations()]() {
+        for (std::uint64_t i = 0; i < n; ++i) {
+            channel->Write(chunk);
+        }
+        channel->CloseChannel();
+    });
+
+    std::uint64_t received = 0;
+    while (true) {
+        const std::string data = channel->Read();
+        if (data.empty() && channel->IsClosed()) {
+            break;
+        }
+        received += data.size();
+    }
+    producer.join();
+
+    DoNotOptimize(received);
+    state.SetBytesProcessed(received);
+    state.SetItemsProcessed(state.Iterations());
+}
+
+// Same as above, but the data passes through `hops` forwarding threads that
+// behave like `cat` in the middle of a pipeline
+template <typename ChannelType>
+void ChannelHops(State &state, std::size_t chunk_size, std::size_t hops) {
+    std::vector<std::shared_ptr<ChannelType>> channels;
+    for (std::size_t i = 0; i <= hops; ++i) {
+        channels.push_back(std::make_shared<ChannelType>());
+    }
+
+    std::vector<std::thread> threads;
+    threads.emplace_back([&channels, chunk_size, n = state.Iterations()]() {
+        for (std::uint64_t i = 0; i < n; ++i) {
+            channels.front()->Write(std::string(chunk_size, 'x'));
+        }
+        channels.front()->CloseChannel();
+    });
+    for (std::size_t i = 0; i < hops; ++i) {
+        threads.emplace_back([in = channels[i], out = channels[i + 1]]() {
+            while (true) {
+                std::string data = in->Read();
+                if (data.empty() && in->IsClosed()) {
+                    break;
+                }
+                out->Write(std::move(data));
+            }
+            out->CloseChannel();
+        });
+    }
+
+    std::uint64_t received = 0;
+    while (true) {
+        const std::string data = channels.back()->Read();
+        if (data.empty() && channels.back()->IsClosed()) {
+            break;
+        }
+        received += data.size();
+    }
+    for (auto &thread : threads) {
+        thread.join();
+    }
+
+    DoNotOptimize(received);
+    state.SetBytesProcessed(received);
+}
+
+template <typename ChannelType>
+void RegisterChannel(const std::string &name) {
+    // 80 bytes mimics `cat` writing line by line, the rest are bulk copies
+    for (const std::size_t chunk_size : {80, 4096, 65536}) {
+        RegisterBenchmark(
+            "channel/" + name + "/" + std::to_string(chunk_size),
+            [chunk_size](State &state) {
+                ChannelThroughput<ChannelType>(state, chunk_size);
+            }
+        );
+    }
+    RegisterBenchmark("channel/" + name + "/hops3/65536", [](State &state) {
+        ChannelHops<ChannelType>(state, 65536, 3);
+    });
+}
+
+const bool kRegistered = []() {
+    RegisterChannel<Channel>("mutex");
+    RegisterChannel<SpscChannel>("spsc");
+    return true;
+}();
+
+}  // namespace
+
+}  // namespace btft::bench
@@ -0,0 +1,68 @@
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "common.h"
+#include "environment.h"
+#include "expansion.h"
+#include "harness.h"
+
+namespace btft::bench {
+
+namespace {
+
+using interpreter::ArgSegment;
+using interpreter::ArgToken;
+using interpreter::ExpansionTemplate;
+
+struct ExpansionCase {
+    std::string name;
+    ArgToken token;
+};
+
+const std::vector<ExpansionCase> &Cases() {
+    static const std::vector<ExpansionCase> cases = {
+        {"literal",
+         ArgToken{{ArgSegment{.text = "/usr/local/share/data.txt"}}}},
+        {"one_var", ArgToken{{ArgSegment{.text = "$BENCH_HOME/data.txt"}}}},
+        {"mixed",
+         ArgToken{
+             {ArgSegment{.text = "--prefix=$BENCH_HOME/"},
+              ArgSegment{.text = "$BENCH_HOME", .allow_expansion = false},
+              ArgSegment{.text = "-$BENCH_USER-$BENCH_UNSET"}}}},
+    };
+    return cases;
+}
+
+const bool kRegistered = []() {
+    for (const auto &expansion_case : Cases()) {
+        RegisterBenchmark(
+            "expand/compile/" + expansion_case.name,
+            [&token = expansion_case.token](State &state) {
+                for (std::uint64_t i = 0; i < state.Iterations(); ++i) {
+                    DoNotOptimize(ExpansionTemplate::Compile(token));
+                }
+                state.SetItemsProcessed(state.Iterations());
+            }
+        );
+        RegisterBenchmark(
+            "expand/run/" + expansion_case.name,
+            [&token = expansion_case.token](State &state) {
+                auto &environment = Environment::GetInstance();
+                environment.SetGlobal("BENCH_HOME", "/home/bench");
+                environment.SetGlobal("BENCH_USER", "bench");
+                const auto env = environment.GetSnapshot();
+                const ExpansionTemplate compiled =
+                    ExpansionTemplate::Compile(token);
+                for (std::uint64_t i = 0; i < state.Iterations(); ++i) {
+                    DoNotOptimize(compiled.Expand(*env));
+                }
+                state.SetItemsProcessed(state.Iterations());
+            }
+        );
+    }
+    return true;
+}();
+
+}  // namespace
+
+}  // namespace btft::bench
@@ -0,0 +1,206 @@
+#include "harness.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace btft::bench {
+
+namespace {
+
+struct Benchmark {
+    std::string name;
+    BenchmarkFunction function;
+};
+
+std::vector<Benchmark> &Benchmarks() {
+    static std::vector<Benchmark> benchmarks;
+    return benchmarks;
+}
+
+enum class Format {
+    kTable,
+    kJson,
+};
+
+struct Options {
+    std::string filter;
+    double min_time = 0.5;
+    Format format = Format::kTable;
+};
+
+struct Measurement {
+    std::uint64_t iterations = 0;
+    double seconds = 0;
+    std::uint64_t bytes = 0;
+    std::uint64_t items = 0;
+};
+
+constexpr std::uint64_t kMaxIterations = 1'000'000'000;
+
+// Doubles (or extrapolates) the iteration count until one run takes at
+// least `min_time` seconds
+Measurement Measure(const Benchmark &benchmark, double min_time) {
+    // One untimed iteration first: inputs built lazily on the first call
+    // (static test data, caches) are not part of the measurement
+    State warm_up(1);
+    benchmark.function(warm_up);
+
+    std::uint64_t iterations = 1;
+    while (true) {
+        State state(iterations);
+        const auto start = std::chrono::steady_clock::now();
+        benchmark.function(state);
+        const std::chrono::duration<double> elapsed =
+            std::chrono::steady_clock::now() - start;
+
+        if (elapsed.count() >= min_time || iterations >= kMaxIterations) {
+            return Measurement{
+                .iterations = iterations,
+                .seconds = elapsed.count(),
+                .bytes = state.GetBytesProcessed(),
+                .items = state.GetItemsProcessed()};
+        }
+
+        const double scale =
+            elapsed.count() > 0 ? min_time * 1.4 / elapsed.count() : 10.0;
+        iterations = std::min(
+            kMaxIterations,
+            std::max(
+                iterations * 2, static_cast<std::uint64_t>(
+                                    static_cast<double>(iterations) *
+                                    std::min(scale, 100.0)
+                                )
+            )
+        );
+    }
+}
+
+double NanosecondsPerIteration(const Measurement &m) {
+    return m.seconds * 1e9 / static_cast<double>(m.iterations);
+}
+
+void PrintMeasurement(const std::string &name, const Measurement &m) {
+    std::printf(
+        "%-48s %12llu %14.1f ns", name.c_str(),
+        static_cast<unsigned long long>(m.iterations),
+        NanosecondsPerIteration(m)
+    );
+    if (m.bytes != 0) {
+        std::printf(
+            " %10.1f MB/s", static_cast<double>(m.bytes) / m.seconds / 1e6
+        );
+    }
+    if (m.items != 0) {
+        std::printf(
+            " %12.0f items/s", static_cast<double>(m.items) / m.seconds
+        );
+    }
+    std::printf("\n");
+    std::fflush(stdout);
+}
+
+// Benchmark names are plain ASCII; quotes and backslashes are escaped all
+// the same so the output always parses
+std::string JsonString(std::string_view text) {
+    std::string quoted = "\"";
+    for (const char c : text) {
+        if (c == '"' || c == '\\') {
+            quoted.push_back('\\');
+        }
+        quoted.push_back(c);
+    }
+    quoted.push_back('"');
+    return quoted;
+}
+
+// One object per benchmark; rates are 0 when the benchmark reports none
+void PrintJsonMeasurement(
+    const std::string &name,
+    const Measurement &m,
+    bool first
+) {
+    std::printf(
+        "%s\n    {\"name\": %s, \"iterations\": %llu, "
+        "\"ns_per_iteration\": %.3f, \"bytes_per_second\": %.1f, "
+        "\"items_per_second\": %.1f}",
+        first ? "" : ",", JsonString(name).c_str(),
+        static_cast<unsigned long long>(m.iterations),
+        NanosecondsPerIteration(m),
+        static_cast<double>(m.bytes) / m.seconds,
+        static_cast<double>(m.items) / m.seconds
+    );
+    std::fflush(stdout);
+}
+
+Options ParseOptions(int argc, char **argv) {
+    Options options;
+    for (int i = 1; i < argc; ++i) {
+        const std::string_view arg = argv[i];
+        if (arg.starts_with("--min-time=")) {
+            options.min_time =
+                std::stod(std::string(arg.substr(arg.find('=') + 1)));
+        } else if (arg == "--format=json") {
+            options.format = Format::kJson;
+        } else if (arg == "--format=table") {
+            options.format = Format::kTable;
+        } else {
+            options.filter = arg;
+        }
+    }
+    return options;
+}
+
+}  // namespace
+
+bool RegisterBenchmark(std::string name, BenchmarkFunction function) {
+    Benchmarks().push_back(Benchmark{
+        .name = std::move(name), .function = std::move(function)});
+    return true;
+}
+
+}  // namespace btft::bench
+
+int main(int argc, char **argv) {
+    // NOLINTNEXTLINE
+    using namespace btft::bench;
+
+    const Options options = ParseOptions(argc, argv);
+    const bool json = options.format == Format::kJson;
+
+    if (json) {
+        // The context lets results from different machines be told apart
+        std::printf(
+            "{\n  \"context\": {\"hardware_concurrency\": %u, "
+            "\"min_time\": %.3f},\n  \"benchmarks\": [",
+            std::thread::hardware_concurrency(), options.min_time
+        );
+    } else {
+        std::printf(
+            "%-48s %12s %17s\n", "Benchmark", "Iterations", "Time/iter"
+        );
+    }
+
+    bool first = true;
+    for (const Benchmark &benchmark : Benchmarks()) {
+        if (benchmark.name.find(options.filter) == std::string::npos) {
+            continue;
+        }
+        const Measurement measurement =
+            Measure(benchmark, options.min_time);
+        if (json) {
+            PrintJsonMeasurement(benchmark.name, measurement, first);
+        } else {
+            PrintMeasurement(benchmark.name, measurement);
+        }
+        first = false;
+    }
+
+    if (json) {
+        std::printf("\n  ]\n}\n");
+    }
+    return 0;
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <string>
+
+namespace btft::bench {
+
+/**
+ * State - per-run context handed to a benchmark body
+ *
+ * The body performs `Iterations()` units of work and may report how many
+ * bytes or items it processed; the runner turns those into throughput.
+ */
+class State final {
+public:
+    explicit State(std::uint64_t iterations) : iterations(iterations) {
+    }
+
+    [[nodiscard]] std::uint64_t Iterations() const noexcept {
+        return iterations;
+    }
+
+    void SetBytesProcessed(std::uint64_t bytes) noexcept {
+        bytes_processed = bytes;
+    }
+
+    [[nodiscard]] std::uint64_t GetBytesProcessed() const noexcept {
+        return bytes_processed;
+    }
+
+    void SetItemsProcessed(std::uint64_t items) noexcept {
+        items_processed = items;
+    }
+
+    [[nodiscard]] std::uint64_t GetItemsProcessed() const noexcept {
+        return items_processed;
+    }
+
+private:
+    std::uint64_t iterations;
+    std::uint64_t bytes_processed = 0;
+    std::uint64_t items_processed = 0;
+};
+
+using BenchmarkFunction = std::function<void(State &)>;
+
+// Adds a benchmark to the global list, returns true so that it can be used
+// to initialize a namespace-scope constant
+bool RegisterBenchmark(std::string name, BenchmarkFunction function);
+
+// Prevents the compiler from optimizing away a computed value
+template <typename T>
+void DoNotOptimize(const T &value) {
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+}  // namespace btft::bench
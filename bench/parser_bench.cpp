@@ -0,0 +1,81 @@
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include "parser/antlr_parser.h"
+#include "parser/descent_parser.h"
+#include "parser/parse_cache.h"
+#include "harness.h"
+
+namespace btft::bench {
+
+namespace {
+
+using parser::AntlrParser;
+using parser::DescentParser;
+using parser::IParser;
+using parser::ParseCache;
+
+struct ParseCase {
+    std::string name;
+    std::string line;
+};
+
+const std::vector<ParseCase> &Cases() {
+    static const std::vector<ParseCase> cases = {
+        {"simple", "echo hello world"},
+        {"pipeline", "cat data.txt | grep -v '^#' | wc"},
+        {"quoted",
+         "echo \"$HOME/dir\" 'literal $x' a\"b\"'c' --flag=value | cat"},
+        {"assignment", "LANG=C count=10 echo \"$count items\""},
+    };
+    return cases;
+}
+
+void ParseLines(State &state, const IParser &parser, const std::string &line) {
+    for (std::uint64_t i = 0; i < state.Iterations(); ++i) {
+        DoNotOptimize(parser.Parse(line));
+    }
+    state.SetBytesProcessed(state.Iterations() * line.size());
+    state.SetItemsProcessed(state.Iterations());
+}
+
+const bool kRegistered = []() {
+    for (const auto &parse_case : Cases()) {
+        RegisterBenchmark(
+            "parser/antlr/" + parse_case.name,
+            [&line = parse_case.line](State &state) {
+                static const AntlrParser parser;
+                ParseLines(state, parser, line);
+            }
+        );
+        RegisterBenchmark(
+            "parser/descent/" + parse_case.name,
+            [&line = parse_case.line](State &state) {
+                static const DescentParser parser(
+                    std::make_unique<AntlrParser>()
+                );
+                ParseLines(state, parser, line);
+            }
+        );
+        RegisterBenchmark(
+            "parser/cached/" + parse_case.name,
+            [&line = parse_case.line](State &state) {
+                static const DescentParser parser(
+                    std::make_unique<AntlrParser>()
+                );
+                auto &cache = ParseCache::GetInstance();
+                for (std::uint64_t i = 0; i < state.Iterations(); ++i) {
+                    DoNotOptimize(cache.Parse(line, parser));
+                }
+                state.SetBytesProcessed(state.Iterations() * line.size());
+                state.SetItemsProcessed(state.Iterations());
+            }
+        );
+    }
+    return true;
+}();
+
+}  // namespace
+
+}  // namespace btft::bench
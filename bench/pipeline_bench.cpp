@@ -0,0 +1,128 @@
+#include <fcntl.h>
+#include <unistd.h>
+#include <cstdint>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "common.h"
+#include "executor/commands/cat.h"
+#include "executor/commands/echo.h"
+#include "executor/commands/registry.h"
+#include "executor/commands/wc.h"
+#include "executor/executor.h"
+#include "executor/stage_pool.h"
+#include "harness.h"
+
+namespace btft::bench {
+
+namespace {
+
+using interpreter::ArgSegment;
+using interpreter::ArgToken;
+using interpreter::CommandNode;
+using interpreter::executor::CommandsRegistry;
+using interpreter::executor::ExecutePipeline;
+using interpreter::executor::FlushOutput;
+using interpreter::executor::StagePool;
+
+// What ExecutePipeline used to do per line: one thread per stage
+void SpawnThreads(State &state, std::size_t stages) {
+    for (std::uint64_t i = 0; i < state.Iterations(); ++i) {
+        std::vector<std::thread> threads;
+        for (std::size_t j = 0; j < stages; ++j) {
+            threads.emplace_back([]() {});
+        }
+        for (auto &thread : threads) {
+            thread.join();
+        }
+    }
+    state.SetItemsProcessed(state.Iterations());
+}
+
+void RunOnPool(State &state, std::size_t stages) {
+    const std::vector<std::function<void()>> jobs(stages, []() {});
+    for (std::uint64_t i = 0; i < state.Iterations(); ++i) {
+        StagePool::GetInstance().RunAll(jobs);
+    }
+    state.SetItemsProcessed(state.Iterations());
+}
+
+ArgToken Word(std::string text) {
+    return ArgToken{.segments = {ArgSegment{.text = std::move(text)}}};
+}
+
+void RegisterBuiltins() {
+    auto &registry = CommandsRegistry::GetInstance();
+    registry.RegisterCommand<interpreter::executor::commands::EchoCommand>(
+        "echo"
+    );
+    registry.RegisterCommand<interpreter::executor::commands::WcCommand>("wc"
+    );
+    registry.RegisterCommand<interpreter::executor::commands::CatCommand>(
+        "cat"
+    );
+}
+
+// Runs a whole command line per iteration with stdout pointed at /dev/null
+void ExecuteLine(State &state, const std::vector<CommandNode> &nodes) {
+    RegisterBuiltins();
+
+    std::cout.flush();
+    const int saved_stdout = ::dup(STDOUT_FILENO);
+    const int null_fd = ::open("/dev/null", O_WRONLY | O_CLOEXEC);
+    ::dup2(null_fd, STDOUT_FILENO);
+    ::close(null_fd);
+
+    for (std::uint64_t i = 0; i < state.Iterations(); ++i) {
+        DoNotOptimize(ExecutePipeline(nodes).exit_code);
+    }
+
+    // Commands' stdout is buffered, it has to reach /dev/null before fd 1
+    // is put back
+    FlushOutput();
+    std::cout.flush();
+    ::dup2(saved_stdout, STDOUT_FILENO);
+    ::close(saved_stdout);
+    state.SetItemsProcessed(state.Iterations());
+}
+
+const bool kRegistered = []() {
+    for (const std::size_t stages : {1, 2, 4}) {
+        const std::string suffix = std::to_string(stages);
+        RegisterBenchmark(
+            "pipeline/stages/thread_per_stage/" + suffix,
+            [stages](State &state) { SpawnThreads(state, stages); }
+        );
+        RegisterBenchmark(
+            "pipeline/stages/stage_pool/" + suffix,
+            [stages](State &state) { RunOnPool(state, stages); }
+        );
+    }
+    RegisterBenchmark("pipeline/execute/echo", [](State &state) {
+        ExecuteLine(state, {CommandNode(Word("echo"), {Word("hello")})});
+    });
+    RegisterBenchmark("pipeline/execute/external_true", [](State &state) {
+        ExecuteLine(state, {CommandNode(Word("true"), {})});
+    });
+    RegisterBenchmark("pipeline/execute/echo_wc", [](State &state) {
+        ExecuteLine(
+            state, {CommandNode(Word("echo"), {Word("hello")}),
+                    CommandNode(Word("wc"), {})}
+        );
+    });
+    // The two cats are fused away, see FuseStages
+    RegisterBenchmark("pipeline/execute/echo_cat_cat_wc", [](State &state) {
+        ExecuteLine(
+            state, {CommandNode(Word("echo"), {Word("hello")}),
+                    CommandNode(Word("cat"), {}), CommandNode(Word("cat"), {}),
+                    CommandNode(Word("wc"), {})}
+        );
+    });
+    return true;
+}();
+
+}  // namespace
+
+}  // namespace btft::bench
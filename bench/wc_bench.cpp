@@ -0,0 +1,73 @@
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <string_view>
+#include "executor/commands/wc_stats.h"
+#include "harness.h"
+
+namespace btft::bench {
+
+namespace {
+
+using interpreter::executor::commands::CountStats;
+using interpreter::executor::commands::CountStatsScalar;
+using interpreter::executor::commands::TextStats;
+
+// Log-like text: words of random length, a newline every ~80 bytes
+std::string MakeText(std::size_t size) {
+    std::mt19937 rng(42);
+    std::string text;
+    text.reserve(size);
+    while (text.size() < size) {
+        const std::size_t word = 1 + rng() % 12;
+        text.append(word, static_cast<char>('a' + rng() % 26));
+        text.push_back(rng() % 8 == 0 ? '\n' : ' ');
+    }
+    text.resize(size);
+    return text;
+}
+
+// Large inputs repeat a 1 MB block instead of drawing every byte, which
+// would take longer than counting them
+std::string RepeatText(const std::string &block, std::size_t size) {
+    std::string text;
+    text.reserve(size);
+    while (text.size() < size) {
+        text.append(block, 0, std::min(block.size(), size - text.size()));
+    }
+    return text;
+}
+
+template <TextStats (*Count)(std::string_view, bool &)>
+void CountText(State &state, const std::string &text) {
+    for (std::uint64_t i = 0; i < state.Iterations(); ++i) {
+        bool in_word = false;
+        const TextStats stats = Count(text, in_word);
+        DoNotOptimize(stats);
+    }
+    state.SetBytesProcessed(state.Iterations() * text.size());
+}
+
+const bool kRegistered = []() {
+    constexpr std::size_t kMegabyte = 1024 * 1024;
+    RegisterBenchmark("wc/count_stats/scalar/1MB", [](State &state) {
+        static const std::string text = MakeText(kMegabyte);
+        CountText<CountStatsScalar>(state, text);
+    });
+    RegisterBenchmark("wc/count_stats/dispatch/1MB", [](State &state) {
+        static const std::string text = MakeText(kMegabyte);
+        CountText<CountStats>(state, text);
+    });
+    // Built only when selected; needs 1 GB of memory
+    RegisterBenchmark("wc/count_stats/dispatch/1GB", [](State &state) {
+        static const std::string text =
+            RepeatText(MakeText(kMegabyte), 1024 * kMegabyte);
+        CountText<CountStats>(state, text);
+    });
+    return true;
+}();
+
+}  // namespace
+
+}  // namespace btft::bench
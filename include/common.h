@@ -3,6 +3,7 @@
 #include <string>
 #include <utility>
 #include <vector>
+#include "expansion.h"
 
 namespace btft::interpreter {
 
@@ -19,10 +20,18 @@ struct ArgToken {
     }
 };
 
+// Nodes compile their tokens for expansion as soon as they are built, so
+// a line that is run again skips the scan for $NAME
 class CommandNode final {
 public:
     CommandNode(ArgToken name, std::vector<ArgToken> args)
-        : name(std::move(name)), args(std::move(args)) {
+        : name(std::move(name)),
+          args(std::move(args)),
+          name_template(ExpansionTemplate::Compile(this->name)) {
+        arg_templates.reserve(this->args.size());
+        for (const auto &arg : this->args) {
+            arg_templates.push_back(ExpansionTemplate::Compile(arg));
+        }
     }
 
     [[nodiscard]] const ArgToken &GetName() const noexcept {
@@ -33,9 +42,48 @@ public:
         return args;
     }
 
+    [[nodiscard]] const ExpansionTemplate &GetNameTemplate() const noexcept {
+        return name_template;
+    }
+
+    [[nodiscard]] const std::vector<ExpansionTemplate> &GetArgTemplates(
+    ) const noexcept {
+        return arg_templates;
+    }
+
 private:
     ArgToken name;
     std::vector<ArgToken> args;
+    ExpansionTemplate name_template;
+    std::vector<ExpansionTemplate> arg_templates;
+};
+
+// NAME=value in front of a statement; the value is expanded when the
+// statement runs, not when it is parsed
+class AssignmentNode final {
+public:
+    AssignmentNode(std::string name, ArgToken value)
+        : name(std::move(name)),
+          value(std::move(value)),
+          value_template(ExpansionTemplate::Compile(this->value)) {
+    }
+
+    [[nodiscard]] const std::string &GetName() const noexcept {
+        return name;
+    }
+
+    [[nodiscard]] const ArgToken &GetValue() const noexcept {
+        return value;
+    }
+
+    [[nodiscard]] const ExpansionTemplate &GetValueTemplate() const noexcept {
+        return value_template;
+    }
+
+private:
+    std::string name;
+    ArgToken value;
+    ExpansionTemplate value_template;
 };
 
 class PipelineNode final {
@@ -46,6 +94,7 @@ public:
         : commands(std::move(commands)) {
     }
 
+    // True if there is no command; the line may still hold assignments
     [[nodiscard]] bool Empty() const noexcept {
         return commands.empty();
     }
@@ -62,7 +111,18 @@ public:
         commands.push_back(std::move(command));
     }
 
+    // Global if the line has no commands, local to them otherwise
+    [[nodiscard]] const std::vector<AssignmentNode> &GetAssignments(
+    ) const noexcept {
+        return assignments;
+    }
+
+    void AddAssignment(AssignmentNode assignment) {
+        assignments.push_back(std::move(assignment));
+    }
+
 private:
+    std::vector<AssignmentNode> assignments;
     std::vector<CommandNode> commands;
 };
 
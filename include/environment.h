@@ -1,12 +1,87 @@
 #pragma once
 
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string_view>
 #include <optional>
 #include <string>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
 namespace btft {
 
+/**
+ * EnvironmentSnapshot - the shell variables as they were at one moment
+ *
+ * Immutable once built, so any number of pipeline stages can read it
+ * without locking while the Environment itself moves on. Local variables
+ * are already merged over the globals.
+ *
+ * The envp array handed to new processes is built on first use and then
+ * kept with the snapshot, so launching processes costs nothing for the
+ * environment until a variable changes.
+ */
+class EnvironmentSnapshot final {
+public:
+    EnvironmentSnapshot(
+        std::unordered_map<std::string, std::string> vars,
+        std::uint64_t version,
+        std::uint64_t path_version
+    )
+        : vars(std::move(vars)),
+          version(version),
+          path_version(path_version) {
+    }
+
+    // Value of the variable, nullptr if it is unset; lives as long as the
+    // snapshot
+    [[nodiscard]] const std::string *Find(const std::string &name
+    ) const noexcept {
+        const auto it = vars.find(name);
+        return it == vars.end() ? nullptr : &it->second;
+    }
+
+    [[nodiscard]] std::optional<std::string> GetVar(const std::string &name
+    ) const {
+        if (const std::string *value = Find(name)) {
+            return *value;
+        }
+        return std::nullopt;
+    }
+
+    // All variables as "KEY=VALUE" strings, the format exec functions expect
+    [[nodiscard]] std::vector<std::string> GetEnvironmentArray() const;
+
+    // Null-terminated envp: the environment the shell was started with,
+    // with the variables of the snapshot replacing entries of the same
+    // name; valid as long as the snapshot
+    [[nodiscard]] char *const *GetEnvp() const;
+
+    // Different for every change made to the Environment
+    [[nodiscard]] std::uint64_t GetVersion() const noexcept {
+        return version;
+    }
+
+    // Bumped whenever the effective PATH may have changed; caches built
+    // from PATH compare it instead of the value itself
+    [[nodiscard]] std::uint64_t GetPathVersion() const noexcept {
+        return path_version;
+    }
+
+private:
+    std::unordered_map<std::string, std::string> vars;
+    std::uint64_t version;
+    std::uint64_t path_version;
+
+    mutable std::once_flag envp_once;
+    // Shell variables as "KEY=VALUE"; inherited entries are not copied,
+    // `envp` points at them in environ directly
+    mutable std::vector<std::string> envp_entries;
+    mutable std::vector<char *> envp;
+};
+
 class Environment final {
 public:
     static Environment &GetInstance() {
@@ -30,9 +105,27 @@ public:
     // Returns a vector of "KEY=VALUE" strings
     std::vector<std::string> GetEnvironmentArray() const;
 
+    // The current variables, shared until the next change: a new snapshot
+    // is built on the first call after a change (copy-on-write)
+    std::shared_ptr<const EnvironmentSnapshot> GetSnapshot() const;
+
 private:
     Environment() = default;
 
+    // Called with the mutex held after every change
+    void Touch(bool path_changed) noexcept {
+        if (path_changed) {
+            ++path_version;
+        }
+        ++version;
+        snapshot.reset();
+    }
+
+    mutable std::mutex mutex;
+    mutable std::shared_ptr<const EnvironmentSnapshot> snapshot;
+    std::uint64_t version = 0;
+    std::uint64_t path_version = 0;
+
     std::unordered_map<std::string, std::string> local_vars;
     std::unordered_map<std::string, std::string> global_vars;
 };
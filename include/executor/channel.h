@@ -1,22 +1,48 @@
 #pragma once
 
 #include <condition_variable>
+#include <cstddef>
 #include <mutex>
-#include <sstream>
+#include <optional>
+#include <stdexcept>
 #include <string>
+#include <vector>
 
 namespace btft::interpreter::executor {
 
+/**
+ * ChannelClosedError - thrown by writers when the other end of the channel
+ * has gone away
+ *
+ * A reading stage closes its input once it has finished, so a producer
+ * blocked on a full channel is released with this error instead of waiting
+ * forever (the in-process analogue of SIGPIPE).
+ */
+class ChannelClosedError final : public std::runtime_error {
+public:
+    using std::runtime_error::runtime_error;
+};
+
 class IChannel {
 public:
     virtual ~IChannel() = default;
     virtual void CloseChannel() = 0;
+
+    // File descriptor behind the channel, if there is one. External
+    // commands attach it to the child process directly instead of copying
+    // the data through a shell thread.
+    [[nodiscard]] virtual std::optional<int> GetFd() const {
+        return std::nullopt;
+    }
 };
 
 class IInputChannel : public IChannel {
 public:
     virtual ~IInputChannel() = default;
 
+    // Returns the next chunk; the caller owns it and may move it further
+    // down the pipeline. An empty chunk on a closed channel means end of
+    // stream.
     virtual std::string Read() = 0;
     virtual bool IsClosed() const = 0;
 };
@@ -26,23 +52,119 @@ public:
     virtual ~IOutputChannel() = default;
 
     virtual void Write(const std::string &buffer) = 0;
+
+    // Hands the chunk over to the channel. Channels that pass strings along
+    // as is (SpscChannel) move the payload instead of copying it, the rest
+    // fall back to the copying overload.
+    virtual void Write(std::string &&buffer) {
+        Write(static_cast<const std::string &>(buffer));
+    }
+
+    // Pushes out data buffered in user space; must be called before
+    // anybody writes to GetFd() directly
+    virtual void Flush() {
+    }
 };
 
+/**
+ * InputStdChannel - the shell's stdin, read with read(2) in large blocks
+ *
+ * Read hands out whatever arrived, up to kBlockSize bytes at a time and
+ * byte for byte (a last line without a newline stays without one). The
+ * REPL takes its own lines from the same buffer through ReadLine, so the
+ * part of a block behind the current line is still there for the next
+ * line or for a builtin reading stdin. End of input is sticky.
+ *
+ * External commands get fd 0 itself (GetFd). ReturnUnread gives them the
+ * buffered rest by seeking back over it, which works when stdin is a file;
+ * from a pipe or terminal those bytes stay with the shell.
+ */
 class InputStdChannel final : public IInputChannel {
 public:
+    static constexpr std::size_t kBlockSize = 64 * 1024;
+
     std::string Read() override;
+
+    // Next line without its newline; false at end of input
+    bool ReadLine(std::string &line);
+
+    // Seeks fd 0 back over the buffered, unread bytes and drops them, if
+    // stdin is seekable; called before a child process reads fd 0
+    void ReturnUnread();
+
     void CloseChannel() override;
     bool IsClosed() const override;
+    [[nodiscard]] std::optional<int> GetFd() const override;
+
+private:
+    // Moves the unread bytes to the front and reads more behind them, once;
+    // false at end of input
+    bool Fill();
+
+    // Allocated once and reused, grown only for lines longer than itself;
+    // [begin, end) is read from fd 0 but not handed out yet
+    std::string buffer;
+    std::size_t begin = 0;
+    std::size_t end = 0;
+    bool eof = false;
 };
 
+/**
+ * OutputStdChannel - the shell's stdout, written with write(2) through a
+ * userspace buffer
+ *
+ * Small writes are collected and go out in blocks of up to kBufferSize
+ * bytes; chunks that large are written directly. On a terminal the buffer
+ * is flushed after every chunk containing a newline, so interactive output
+ * appears line by line. The shell flushes the channel after every
+ * interactive line and at the end of a script (executor::FlushOutput), and
+ * everybody who writes to fd 1 directly (child processes, kernel copies)
+ * must Flush first. A failed write (EPIPE) drops the
+ * buffer and throws ChannelClosedError.
+ */
 class OutputStdChannel final : public IOutputChannel {
 public:
+    static constexpr std::size_t kBufferSize = 64 * 1024;
+
+    OutputStdChannel();
+    ~OutputStdChannel() override;
+
+    OutputStdChannel(const OutputStdChannel &) = delete;
+    OutputStdChannel(OutputStdChannel &&) = delete;
+    OutputStdChannel &operator=(const OutputStdChannel &) = delete;
+    OutputStdChannel &operator=(OutputStdChannel &&) = delete;
+
+    using IOutputChannel::Write;
     void Write(const std::string &buffer) override;
+    void Flush() override;
     void CloseChannel() override;
+    [[nodiscard]] std::optional<int> GetFd() const override;
+
+private:
+    // Writes out `pending`; mutex held
+    void FlushPending();
+
+    std::mutex mutex;
+    std::string pending;
+    bool line_buffered = false;
 };
 
+/**
+ * Channel - bounded in-process pipe between two pipeline stages
+ *
+ * Data is stored in a fixed-capacity ring buffer, so memory per pipeline
+ * stage does not depend on the amount of data flowing through it. Write
+ * blocks while the buffer is full, Read blocks while it is empty. Closing
+ * the channel from either side wakes up both of them: the reader drains what
+ * is left and then gets an empty string, the writer gets ChannelClosedError.
+ */
 class Channel final : virtual public IOutputChannel, public IInputChannel {
 public:
+    static constexpr std::size_t kDefaultCapacity = 64 * 1024;
+
+    explicit Channel(std::size_t capacity = kDefaultCapacity);
+
+    using IOutputChannel::Write;
     void Write(const std::string &buffer) override;
     std::string Read() override;
     void CloseChannel() override;
@@ -50,8 +172,11 @@ public:
 
 private:
     mutable std::mutex mutex;
-    std::condition_variable condVar;
-    std::stringstream readBuffer;
+    std::condition_variable not_empty;
+    std::condition_variable not_full;
+    std::vector<char> ring;
+    std::size_t head = 0;
+    std::size_t size = 0;
     bool closed = false;
 };
 
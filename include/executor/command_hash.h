@@ -0,0 +1,77 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "environment.h"
+
+namespace btft::interpreter::executor {
+
+/**
+ * CommandHash - remembers where external commands were found in PATH
+ *
+ * Like the hash table of bash: the first lookup of a name walks PATH, later
+ * ones are a single map lookup. The table is dropped as soon as PATH changes
+ * in the Environment, and can be inspected or cleared with the `hash`
+ * builtin. Names containing a slash are never looked up or remembered.
+ *
+ * Lookups take the EnvironmentSnapshot of the running pipeline, PATH is
+ * read from it and the table is checked against its PATH version.
+ */
+class CommandHash final {
+public:
+    struct Entry {
+        std::string name;
+        std::string path;
+        std::size_t hits = 0;
+    };
+
+    static CommandHash &GetInstance() {
+        static CommandHash instance;
+        return instance;
+    }
+
+    // Absolute (or as given) path of the executable, nullopt if PATH has no
+    // such command
+    std::optional<std::string> Resolve(
+        const std::string &name,
+        const EnvironmentSnapshot &env
+    );
+
+    // Walks PATH again and refreshes the entry without counting a hit, e.g.
+    // after the remembered file has disappeared
+    std::optional<std::string> Rehash(
+        const std::string &name,
+        const EnvironmentSnapshot &env
+    );
+
+    void Forget(const std::string &name);
+    void Clear();
+
+    // Snapshot of the table, sorted by name
+    [[nodiscard]] std::vector<Entry> GetEntries(
+        const EnvironmentSnapshot &env
+    );
+
+private:
+    CommandHash() = default;
+
+    CommandHash(const CommandHash &other) = delete;
+    CommandHash(CommandHash &&other) = delete;
+
+    CommandHash &operator=(const CommandHash &other) = delete;
+    CommandHash &operator=(CommandHash &&other) = delete;
+
+    // Drops the table if PATH changed since it was filled; mutex held
+    void Validate(const EnvironmentSnapshot &env);
+
+    std::mutex mutex;
+    std::unordered_map<std::string, Entry> table;
+    std::uint64_t path_version = 0;
+};
+
+}  // namespace btft::interpreter::executor
@@ -28,6 +28,11 @@ public:
         std::shared_ptr<IInputChannel> input_channel,
         std::shared_ptr<IOutputChannel> output_channel
     ) override;
+    StageTask ExecuteCooperative(
+        const std::vector<std::string> &args,
+        CooperativeChannel &input,
+        std::shared_ptr<IOutputChannel> output
+    ) override;
 
     static std::shared_ptr<ICommand> CreateCommand() {
         return std::make_shared<CatCommand>();
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <memory>
+#include "environment.h"
 #include "icommand.h"
 
 namespace btft::interpreter::executor::commands {
@@ -17,19 +19,41 @@ namespace btft::interpreter::executor::commands {
  * Pipeline examples:
  * - ls | grep ".txt" → lists files and filters for .txt files
  * - cat file.txt | sort → reads file and sorts the content
+ *
+ * PATH and the child's environment come from the snapshot the pipeline
+ * was started with, not from the live Environment. The command keeps no
+ * state of its own, so one instance serves every launch.
  */
 class ExternalCommand final : public ICommand {
 public:
-    ExternalCommand() = default;
+    static ExternalCommand &GetInstance() {
+        static ExternalCommand instance;
+        return instance;
+    }
+
+    // Runs args[0] with the variables of `env`
+    ExecutionResult Execute(
+        const EnvironmentSnapshot &env,
+        const std::vector<std::string> &args,
+        std::shared_ptr<IInputChannel> input_channel,
+        std::shared_ptr<IOutputChannel> output_channel
+    );
+
+    // Same, with the current snapshot of the live Environment
     ExecutionResult Execute(
         const std::vector<std::string> &args,
         std::shared_ptr<IInputChannel> input_channel,
         std::shared_ptr<IOutputChannel> output_channel
     ) override;
 
-    static std::shared_ptr<ICommand> CreateCommand() {
-        return std::make_shared<ExternalCommand>();
-    }
+private:
+    ExternalCommand() = default;
+
+    ExternalCommand(const ExternalCommand &other) = delete;
+    ExternalCommand(ExternalCommand &&other) = delete;
+
+    ExternalCommand &operator=(const ExternalCommand &other) = delete;
+    ExternalCommand &operator=(ExternalCommand &&other) = delete;
 };
 
 }  // namespace btft::interpreter::executor::commands
@@ -0,0 +1,33 @@
+#pragma once
+
+#include "icommand.h"
+
+namespace btft::interpreter::executor::commands {
+
+/**
+ * HashCommand - shows and manages the table of remembered command paths
+ *
+ * Without arguments it prints every remembered command with the number of
+ * times it was run from the table. `-r` empties the table, any other
+ * argument is looked up in PATH and remembered.
+ *
+ * Examples:
+ * - hash → "hits\tcommand" followed by one line per command
+ * - hash -r → forgets all commands
+ * - hash ls grep → remembers where ls and grep live
+ */
+class HashCommand final : public ICommand {
+public:
+    HashCommand() = default;
+    ExecutionResult Execute(
+        const std::vector<std::string> &args,
+        std::shared_ptr<IInputChannel> input_channel,
+        std::shared_ptr<IOutputChannel> output_channel
+    ) override;
+
+    static std::shared_ptr<ICommand> CreateCommand() {
+        return std::make_shared<HashCommand>();
+    }
+};
+
+}  // namespace btft::interpreter::executor::commands
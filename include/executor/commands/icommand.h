@@ -6,6 +6,7 @@
 #include <vector>
 #include "common.h"
 #include "executor/channel.h"
+#include "executor/cooperative.h"
 
 namespace btft::interpreter::executor::commands {
 
@@ -18,6 +19,16 @@ public:
         std::shared_ptr<IOutputChannel> outputChannel
     ) = 0;
 
+    // Coroutine flavour of Execute, used when the whole pipeline consists
+    // of builtins and runs on one thread. The default runs Execute as is,
+    // which is only right for commands that never wait for input: commands
+    // reading it must override this and co_await input.Read().
+    virtual StageTask ExecuteCooperative(
+        const std::vector<std::string> &args,
+        CooperativeChannel &input,
+        std::shared_ptr<IOutputChannel> output
+    );
+
     static std::shared_ptr<ICommand> CreateCommand() {
         throw std::runtime_error("Unimplemented");
     }
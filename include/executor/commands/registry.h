@@ -1,11 +1,78 @@
 #pragma once
 
-#include <unordered_map>
-#include "executor/commands/external.h"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
 #include "icommand.h"
 
 namespace btft::interpreter::executor {
 
+// Every name main.cpp may register as a builtin; FindCommand answers from
+// a perfect hash over exactly these, built at compile time
+inline constexpr std::array<std::string_view, 7> kBuiltinNames = {
+    "echo", "cat", "pwd", "wc", "exit", "hash", "stats"};
+
+namespace builtin_table {
+
+inline constexpr std::size_t kSize = 16;
+
+// FNV-1a started from a seed, reduced to a slot of the table. The low
+// bits of FNV only depend on the low bits of its input, so the high half
+// is folded in first
+constexpr std::size_t Slot(std::string_view name, std::uint32_t seed) {
+    std::uint32_t hash = 2166136261U ^ seed;
+    for (const char c : name) {
+        hash ^= static_cast<unsigned char>(c);
+        hash *= 16777619U;
+    }
+    return (hash ^ (hash >> 16U)) % kSize;
+}
+
+struct Table {
+    std::uint32_t seed = 0;
+    // Index into kBuiltinNames, -1 for an empty slot
+    std::array<std::int8_t, kSize> slots{};
+};
+
+// Tries seeds until no two builtins share a slot; failing to find one
+// fails the build
+constexpr Table Build() {
+    for (std::uint32_t seed = 0; seed < 1U << 16U; ++seed) {
+        Table table{.seed = seed};
+        table.slots.fill(-1);
+        bool perfect = true;
+        for (std::size_t i = 0; i < kBuiltinNames.size() && perfect; ++i) {
+            auto &slot = table.slots[Slot(kBuiltinNames[i], seed)];
+            perfect = slot < 0;
+            slot = static_cast<std::int8_t>(i);
+        }
+        if (perfect) {
+            return table;
+        }
+    }
+    throw std::logic_error("no perfect hash for kBuiltinNames");
+}
+
+inline constexpr Table kTable = Build();
+
+// Position of `name` in kBuiltinNames: one hash and one comparison
+constexpr std::optional<std::size_t> Find(std::string_view name) {
+    const std::int8_t index = kTable.slots[Slot(name, kTable.seed)];
+    if (index < 0 || kBuiltinNames[static_cast<std::size_t>(index)] != name) {
+        return std::nullopt;
+    }
+    return static_cast<std::size_t>(index);
+}
+
+static_assert(Find("echo") == 0 && Find("stats") == 6 && !Find("ls"));
+
+}  // namespace builtin_table
+
 class CommandsRegistry {
 public:
     static CommandsRegistry &GetInstance() {
@@ -14,17 +81,22 @@ public:
     }
 
     template <commands::DerivedFromICommand CommandType>
-    void RegisterCommand(const std::string &name) {
-        registry.emplace(name, CommandType::CreateCommand());
+    void RegisterCommand(std::string_view name) {
+        const std::optional<std::size_t> index = builtin_table::Find(name);
+        if (!index) {
+            throw std::invalid_argument(
+                "not a builtin name: " + std::string(name)
+            );
+        }
+        registry[*index] = CommandType::CreateCommand();
     }
 
-    std::shared_ptr<commands::ICommand> GetCommand(const std::string &name) {
-        const auto command_iterator = registry.find(name);
-        if (command_iterator == registry.end()) {
-            // Return external command for unknown commands
-            return std::make_shared<commands::ExternalCommand>();
-        }
-        return command_iterator->second;
+    // The builtin registered under `name`, nullptr for anything else: the
+    // executor runs those as an ExternalCommand. Neither allocates
+    [[nodiscard]] commands::ICommand *FindCommand(std::string_view name
+    ) const {
+        const std::optional<std::size_t> index = builtin_table::Find(name);
+        return index ? registry[*index].get() : nullptr;
     }
 
 private:
@@ -36,7 +108,8 @@ private:
     CommandsRegistry &operator=(const CommandsRegistry &other) = delete;
     CommandsRegistry &operator=(CommandsRegistry &&other) = delete;
 
-    std::unordered_map<std::string, std::shared_ptr<commands::ICommand>>
+    // Indexed like kBuiltinNames; empty for names never registered
+    std::array<std::shared_ptr<commands::ICommand>, kBuiltinNames.size()>
         registry;
 };
 }  // namespace btft::interpreter::executor
@@ -0,0 +1,31 @@
+#pragma once
+
+#include "icommand.h"
+
+namespace btft::interpreter::executor::commands {
+
+/**
+ * StatsCommand - reports how well the shell's caches are doing
+ *
+ * Prints the hits, misses and hit rate of the parse cache together with
+ * how many lines it holds. `-r` empties the cache and resets the counters.
+ *
+ * Examples:
+ * - stats → "parse cache: 3 hits, 1 misses, 75.0% hit rate, 1/256 lines"
+ * - stats -r → forgets all cached lines
+ */
+class StatsCommand final : public ICommand {
+public:
+    StatsCommand() = default;
+    ExecutionResult Execute(
+        const std::vector<std::string> &args,
+        std::shared_ptr<IInputChannel> input_channel,
+        std::shared_ptr<IOutputChannel> output_channel
+    ) override;
+
+    static std::shared_ptr<ICommand> CreateCommand() {
+        return std::make_shared<StatsCommand>();
+    }
+};
+
+}  // namespace btft::interpreter::executor::commands
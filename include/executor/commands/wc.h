@@ -26,10 +26,38 @@ public:
         std::shared_ptr<IInputChannel> inputChannel,
         std::shared_ptr<IOutputChannel> outputChannel
     ) override;
+    StageTask ExecuteCooperative(
+        const std::vector<std::string> &args,
+        CooperativeChannel &input,
+        std::shared_ptr<IOutputChannel> output
+    ) override;
 
     static std::shared_ptr<ICommand> CreateCommand() {
         return std::make_shared<WcCommand>();
     }
 };
 
+/**
+ * CatWcCommand - `cat FILE... | wc` as a single stage
+ *
+ * The executor puts this in place of that pair of stages (see
+ * FuseStages). The files are counted as one stream, the way `wc` would
+ * have received them from `cat`, but straight from disk: mapped and split
+ * between threads like `wc FILE`, with no channel in between. Output and
+ * exit code match the pair's: the counts of whatever `cat` would have
+ * passed on, and 1 if a file could not be read.
+ *
+ * Never registered under a name; the input channel is ignored, like
+ * `cat FILE` ignores it.
+ */
+class CatWcCommand final : public ICommand {
+public:
+    CatWcCommand() = default;
+    ExecutionResult Execute(
+        const std::vector<std::string> &args,
+        std::shared_ptr<IInputChannel> inputChannel,
+        std::shared_ptr<IOutputChannel> outputChannel
+    ) override;
+};
+
 }  // namespace btft::interpreter::executor::commands
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <cstddef>
+#include <string_view>
+#include <vector>
+
+namespace btft::interpreter::executor::commands {
+
+struct TextStats {
+    std::size_t lines = 0;
+    std::size_t words = 0;
+    std::size_t bytes = 0;
+
+    TextStats &operator+=(const TextStats &other) noexcept {
+        lines += other.lines;
+        words += other.words;
+        bytes += other.bytes;
+        return *this;
+    }
+};
+
+// C locale whitespace: ' ', '\t', '\n', '\v', '\f', '\r'
+constexpr bool IsWhitespace(unsigned char c) noexcept {
+    return c == ' ' || (c >= '\t' && c <= '\r');
+}
+
+/**
+ * CountStats - counts lines, words and bytes the way `wc` does
+ *
+ * A line is a '\n', a word is a maximal run of bytes that are not
+ * IsWhitespace. The counting kernel is picked once at runtime: AVX2 or SSE2
+ * on x86, scalar elsewhere. All of them give identical results.
+ *
+ * `in_word` carries the word state between consecutive pieces of one stream
+ * (false before the first piece), so a word split across two pieces is
+ * counted once.
+ */
+TextStats CountStats(std::string_view content, bool &in_word);
+
+TextStats CountStats(std::string_view content);
+
+/**
+ * StatsCounter - CountStats over a stream that arrives in chunks
+ *
+ * Only the running totals and the word state are kept, so counting an
+ * unbounded stream takes constant memory.
+ */
+class StatsCounter final {
+public:
+    void Update(std::string_view chunk) {
+        stats += CountStats(chunk, in_word);
+    }
+
+    [[nodiscard]] const TextStats &GetStats() const noexcept {
+        return stats;
+    }
+
+private:
+    TextStats stats;
+    bool in_word = false;
+};
+
+// Byte-at-a-time reference implementation of CountStats
+TextStats CountStatsScalar(std::string_view content, bool &in_word);
+
+// A counting kernel CountStats may pick, by name ("scalar", "sse2", ...)
+struct CountKernel {
+    std::string_view name;
+    TextStats (*count)(std::string_view content, bool &in_word);
+};
+
+// Every kernel this CPU can run, the scalar reference first; for tests
+std::vector<CountKernel> AvailableCountKernels();
+
+}  // namespace btft::interpreter::executor::commands
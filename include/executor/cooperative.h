@@ -0,0 +1,149 @@
+#pragma once
+
+#include <coroutine>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <string>
+#include <utility>
+#include "common.h"
+#include "executor/channel.h"
+
+namespace btft::interpreter::executor {
+
+/**
+ * StageTask - coroutine running one builtin of a cooperative pipeline
+ *
+ * The task starts suspended and is driven by the executor through Resume.
+ * It suspends only while waiting for input (see CooperativeChannel::Read)
+ * and keeps the command's result, or the exception it ended with, until
+ * TakeResult.
+ */
+class StageTask final {
+public:
+    struct promise_type {
+        ExecutionResult result;
+        std::exception_ptr exception;
+
+        StageTask get_return_object() {
+            return StageTask(
+                std::coroutine_handle<promise_type>::from_promise(*this)
+            );
+        }
+
+        std::suspend_always initial_suspend() noexcept {
+            return {};
+        }
+
+        std::suspend_always final_suspend() noexcept {
+            return {};
+        }
+
+        void return_value(ExecutionResult value) {
+            result = std::move(value);
+        }
+
+        void unhandled_exception() noexcept {
+            exception = std::current_exception();
+        }
+    };
+
+    StageTask(StageTask &&other) noexcept
+        : handle(std::exchange(other.handle, nullptr)) {
+    }
+
+    StageTask &operator=(StageTask &&other) noexcept;
+    ~StageTask();
+
+    StageTask(const StageTask &) = delete;
+    StageTask &operator=(const StageTask &) = delete;
+
+    void Resume() const {
+        handle.resume();
+    }
+
+    [[nodiscard]] bool Done() const noexcept {
+        return handle.done();
+    }
+
+    // Result of a finished task; rethrows what escaped the coroutine body
+    ExecutionResult TakeResult();
+
+private:
+    explicit StageTask(std::coroutine_handle<promise_type> handle)
+        : handle(handle) {
+    }
+
+    std::coroutine_handle<promise_type> handle;
+};
+
+/**
+ * CooperativeChannel - input of a stage in a single-threaded pipeline
+ *
+ * Between two stages the channel is a push-style pipe: Write stores the
+ * chunk and immediately resumes the waiting reader on the writer's stack,
+ * so at most one chunk is ever buffered and no stage needs a thread of its
+ * own. The first stage's channel wraps a blocking source (stdin) instead
+ * and never suspends.
+ *
+ * Writing after the reader has finished throws ChannelClosedError, closing
+ * the writing side hands the reader an empty chunk with IsClosed() set.
+ */
+class CooperativeChannel final : public IOutputChannel {
+public:
+    class ReadAwaiter final {
+    public:
+        explicit ReadAwaiter(CooperativeChannel &channel) : channel(channel) {
+        }
+
+        [[nodiscard]] bool await_ready() const noexcept;
+        void await_suspend(std::coroutine_handle<> reader) noexcept;
+        std::string await_resume();
+
+    private:
+        CooperativeChannel &channel;
+    };
+
+    // Pipe between two stages; `resume_reader` continues the reading stage
+    // once data or end of stream arrives
+    explicit CooperativeChannel(std::function<void()> resume_reader)
+        : resume_reader(std::move(resume_reader)) {
+    }
+
+    // Input of the first stage, read synchronously from `source`
+    explicit CooperativeChannel(std::shared_ptr<IInputChannel> source)
+        : source(std::move(source)) {
+    }
+
+    // co_await the result; same contract as IInputChannel::Read
+    [[nodiscard]] ReadAwaiter Read() {
+        return ReadAwaiter(*this);
+    }
+
+    [[nodiscard]] bool IsClosed() const;
+
+    // Called once the reading stage is done, later writes throw
+    void CloseReader();
+
+    // The input as a plain blocking channel, for commands that run Execute
+    // unchanged: the source itself, or an empty closed channel for a pipe
+    [[nodiscard]] std::shared_ptr<IInputChannel> AsInputChannel() const;
+
+    using IOutputChannel::Write;
+    void Write(const std::string &buffer) override;
+    void Write(std::string &&buffer) override;
+    void CloseChannel() override;
+
+private:
+    void WakeReader();
+
+    std::shared_ptr<IInputChannel> source;
+    std::function<void()> resume_reader;
+    std::deque<std::string> chunks;
+    bool reader_waiting = false;
+    bool writer_closed = false;
+    bool reader_closed = false;
+};
+
+}  // namespace btft::interpreter::executor
@@ -1,9 +1,28 @@
 #pragma once
 
+#include <string>
+#include <vector>
 #include "common.h"
 
 namespace btft::interpreter::executor {
 
 ExecutionResult ExecutePipeline(const std::vector<CommandNode> &nodes);
 
+// Runs a lone command on the calling thread, straight against stdin and
+// stdout: no pipeline state, no inner channels, no worker
+ExecutionResult ExecuteCommand(const CommandNode &node);
+
+// Next line of the shell's stdin, without the newline; false at end of
+// input. Shares the buffer of the commands' stdin, so whatever was read
+// past the line is still there for them.
+bool ReadInputLine(std::string &line);
+
+// Commands write stdout through a buffer; the shell flushes it before it
+// prints anything itself and whenever output has to be visible (a prompt)
+void FlushOutput();
+
+// Sets the variables assigned on the line, in order: globals if it has no
+// commands, locals of its commands otherwise
+void ApplyAssignments(const PipelineNode &pipeline);
+
 }  // namespace btft::interpreter::executor
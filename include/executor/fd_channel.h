@@ -0,0 +1,76 @@
+#pragma once
+
+#include <memory>
+#include <optional>
+#include <string>
+#include <utility>
+#include "executor/channel.h"
+
+namespace btft::interpreter::executor {
+
+/**
+ * FdInputChannel - reading end of a file descriptor, usually a pipe(2)
+ *
+ * The channel owns the descriptor and closes it on CloseChannel. Reads
+ * return whatever a single read(2) delivers, at most kReadChunkSize bytes.
+ */
+class FdInputChannel final : public IInputChannel {
+public:
+    static constexpr std::size_t kReadChunkSize = 64 * 1024;
+
+    explicit FdInputChannel(int fd) : fd(fd) {
+    }
+
+    ~FdInputChannel() override;
+
+    FdInputChannel(const FdInputChannel &) = delete;
+    FdInputChannel(FdInputChannel &&) = delete;
+    FdInputChannel &operator=(const FdInputChannel &) = delete;
+    FdInputChannel &operator=(FdInputChannel &&) = delete;
+
+    std::string Read() override;
+    void CloseChannel() override;
+    bool IsClosed() const override;
+    [[nodiscard]] std::optional<int> GetFd() const override;
+
+private:
+    int fd;
+    bool eof = false;
+};
+
+/**
+ * FdOutputChannel - writing end of a file descriptor, usually a pipe(2)
+ *
+ * The channel owns the descriptor and closes it on CloseChannel, which is
+ * what delivers end of file to the reader. Writing into a pipe nobody reads
+ * anymore throws ChannelClosedError.
+ */
+class FdOutputChannel final : public IOutputChannel {
+public:
+    explicit FdOutputChannel(int fd) : fd(fd) {
+    }
+
+    ~FdOutputChannel() override;
+
+    FdOutputChannel(const FdOutputChannel &) = delete;
+    FdOutputChannel(FdOutputChannel &&) = delete;
+    FdOutputChannel &operator=(const FdOutputChannel &) = delete;
+    FdOutputChannel &operator=(FdOutputChannel &&) = delete;
+
+    using IOutputChannel::Write;
+    void Write(const std::string &buffer) override;
+    void CloseChannel() override;
+    [[nodiscard]] std::optional<int> GetFd() const override;
+
+private:
+    int fd;
+};
+
+// Creates a kernel pipe whose descriptors are not inherited by child
+// processes (external commands get them through dup2 only). Atomic on
+// Linux; elsewhere close-on-exec is set right after pipe(2), and a child
+// spawned by another thread in between can still inherit the ends.
+std::pair<std::shared_ptr<FdInputChannel>, std::shared_ptr<FdOutputChannel>>
+MakePipe();
+
+}  // namespace btft::interpreter::executor
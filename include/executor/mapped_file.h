@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstddef>
+#include <optional>
+#include <string_view>
+#include <type_traits>
+
+namespace btft::interpreter::executor {
+
+/**
+ * MappedFile - read-only mmap(2) of a whole regular file
+ *
+ * The mapping is advised as MADV_SEQUENTIAL so the kernel reads ahead
+ * aggressively and drops pages behind the reader. Mapping costs a few
+ * syscalls and page faults up front, which only pays off for larger files:
+ * callers should use plain reads below kMinSize.
+ *
+ * If the file is truncated while it is mapped, touching a page past the
+ * new end raises SIGBUS instead of returning a short read. Every access to
+ * View() must therefore happen inside Guarded, or be a system call that
+ * reports EFAULT for such pages (write(2)).
+ */
+class MappedFile final {
+public:
+    static constexpr std::size_t kMinSize = 256 * 1024;
+
+    // Maps `size` bytes of `fd` from the start; nullopt if the kernel
+    // refuses (empty file, special file, out of address space, ...)
+    static std::optional<MappedFile> Map(int fd, std::size_t size);
+
+    ~MappedFile();
+
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+    MappedFile(MappedFile &&other) noexcept;
+    MappedFile &operator=(MappedFile &&other) noexcept;
+
+    [[nodiscard]] std::string_view View() const noexcept {
+        return {static_cast<const char *>(data), size};
+    }
+
+    // Runs `body` with SIGBUS caught on this thread; returns false if it
+    // touched a page the file no longer has. `body` is then abandoned
+    // without unwinding, so it may only read memory and compute: no
+    // allocations, locks or objects with destructors inside it.
+    template <typename Body>
+    static bool Guarded(Body &&body) {
+        using BodyType = std::remove_reference_t<Body>;
+        return RunGuarded(
+            [](void *context) { (*static_cast<BodyType *>(context))(); },
+            static_cast<void *>(&body)
+        );
+    }
+
+private:
+    static bool RunGuarded(void (*body)(void *), void *context);
+
+    MappedFile(void *data, std::size_t size) : data(data), size(size) {
+    }
+
+    void Unmap() noexcept;
+
+    void *data = nullptr;
+    std::size_t size = 0;
+};
+
+}  // namespace btft::interpreter::executor
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <unistd.h>
+#include <utility>
+
+namespace btft::interpreter::executor {
+
+/**
+ * ScopedFd - owns a file descriptor and closes it on destruction
+ *
+ * A negative value means "no descriptor", e.g. a failed open(2).
+ */
+class ScopedFd final {
+public:
+    ScopedFd() = default;
+
+    explicit ScopedFd(int fd) : fd(fd) {
+    }
+
+    ~ScopedFd() {
+        Reset();
+    }
+
+    ScopedFd(const ScopedFd &) = delete;
+    ScopedFd &operator=(const ScopedFd &) = delete;
+
+    ScopedFd(ScopedFd &&other) noexcept : fd(std::exchange(other.fd, -1)) {
+    }
+
+    ScopedFd &operator=(ScopedFd &&other) noexcept {
+        if (this != &other) {
+            Reset();
+            fd = std::exchange(other.fd, -1);
+        }
+        return *this;
+    }
+
+    [[nodiscard]] int Get() const noexcept {
+        return fd;
+    }
+
+    [[nodiscard]] bool IsValid() const noexcept {
+        return fd >= 0;
+    }
+
+    void Reset() noexcept {
+        if (fd >= 0) {
+            ::close(fd);
+            fd = -1;
+        }
+    }
+
+private:
+    int fd = -1;
+};
+
+}  // namespace btft::interpreter::executor
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "executor/channel.h"
+
+namespace btft::interpreter::executor {
+
+/**
+ * SpscChannel - lock-free single-producer/single-consumer pipe between two
+ * pipeline stages
+ *
+ * Every channel built by ExecutePipeline has exactly one writer thread and
+ * one reader thread, so no mutex is needed: the writer owns `tail`, the
+ * reader owns `head`, and each written chunk occupies one slot of a fixed
+ * ring. A chunk written with Write(std::string &&) is moved into its slot and
+ * moved out again by Read, so the payload crosses the channel without being
+ * copied.
+ *
+ * A side that cannot make progress spins for a short while and then parks
+ * on a futex word (std::atomic::wait), which the other side bumps after
+ * every operation. Like Channel, the amount of buffered data is bounded by
+ * `capacity` bytes (a single oversized chunk is still let through), and
+ * closing from either side releases both of them.
+ */
+class SpscChannel final : virtual public IOutputChannel, public IInputChannel {
+public:
+    static constexpr std::size_t kDefaultCapacity = 64 * 1024;
+    static constexpr std::size_t kSlots = 256;
+
+    explicit SpscChannel(std::size_t capacity = kDefaultCapacity);
+
+    void Write(const std::string &buffer) override;
+    void Write(std::string &&buffer) override;
+    std::string Read() override;
+    void CloseChannel() override;
+    bool IsClosed() const override;
+
+private:
+    static constexpr std::size_t kCacheLine = 64;
+
+    [[nodiscard]] bool HasRoom(std::size_t tail_index, std::size_t bytes)
+        const noexcept;
+
+    std::vector<std::string> slots;
+    const std::size_t capacity;
+
+    // Reader-owned
+    alignas(kCacheLine) std::atomic<std::size_t> head{0};
+    std::atomic<std::size_t> bytes_read{0};
+    std::atomic<bool> reader_parked{false};
+
+    // Writer-owned
+    alignas(kCacheLine) std::atomic<std::size_t> tail{0};
+    std::atomic<std::size_t> bytes_written{0};
+    std::atomic<bool> writer_parked{false};
+
+    // Futex words: bumped to wake the reader or the writer respectively
+    alignas(kCacheLine) std::atomic<std::uint32_t> readable_epoch{0};
+    alignas(kCacheLine) std::atomic<std::uint32_t> writable_epoch{0};
+
+    std::atomic<bool> closed{false};
+};
+
+}  // namespace btft::interpreter::executor
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <latch>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace btft::interpreter::executor {
+
+/**
+ * StagePool - reusable threads that run the stages of a pipeline
+ *
+ * Stages of one pipeline block on each other through their channels, so
+ * they must all run at the same time: the pool never queues a stage behind
+ * another one, it starts new workers whenever there are fewer idle ones
+ * than stages. Workers stay around for the next line, so a script running
+ * thousands of short pipelines creates threads only for its widest one.
+ */
+class StagePool final {
+public:
+    static StagePool &GetInstance() {
+        static StagePool instance;
+        return instance;
+    }
+
+    // Runs all jobs concurrently and returns once every one has finished.
+    // The last job runs on the calling thread.
+    void RunAll(const std::vector<std::function<void()>> &jobs);
+
+    // Number of worker threads started so far
+    [[nodiscard]] std::size_t GetWorkerCount() const;
+
+private:
+    StagePool() = default;
+    ~StagePool();
+
+    StagePool(const StagePool &other) = delete;
+    StagePool(StagePool &&other) = delete;
+
+    StagePool &operator=(const StagePool &other) = delete;
+    StagePool &operator=(StagePool &&other) = delete;
+
+    struct QueuedJob {
+        const std::function<void()> *job = nullptr;
+        std::latch *done = nullptr;
+    };
+
+    void WorkerLoop();
+
+    mutable std::mutex mutex;
+    std::condition_variable job_ready;
+    std::deque<QueuedJob> queue;
+    std::vector<std::thread> workers;
+    std::size_t idle_workers = 0;
+    bool stopping = false;
+};
+
+}  // namespace btft::interpreter::executor
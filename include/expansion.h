@@ -0,0 +1,75 @@
+#pragma once
+
+#include <concepts>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace btft {
+class EnvironmentSnapshot;
+}  // namespace btft
+
+namespace btft::interpreter {
+
+struct ArgToken;
+
+/**
+ * ExpansionTemplate - an ArgToken compiled for variable expansion
+ *
+ * The token is scanned for `$NAME` once, when the line is parsed, and kept
+ * as its literal text plus the positions where variable values go.
+ * Expanding is then a single concatenation with one lookup per variable;
+ * a token without variables just hands back its literal.
+ */
+class ExpansionTemplate final {
+public:
+    ExpansionTemplate() = default;
+
+    // Quoted segments with expansion disabled stay literal, in the others
+    // every $NAME becomes a slot; a `$` not followed by a name is kept
+    static ExpansionTemplate Compile(const ArgToken &token);
+
+    [[nodiscard]] bool IsLiteral() const noexcept {
+        return slots.empty();
+    }
+
+    // The text with every slot filled in from `env`, unset variables
+    // expand to nothing
+    [[nodiscard]] std::string Expand(const EnvironmentSnapshot &env) const;
+
+    // Same, with each value taken from `lookup(name)`: anything that tests
+    // false for an unset variable and dereferences to the value, such as
+    // Environment::GetVar for expanding against the live variables
+    template <typename Lookup>
+        requires std::invocable<const Lookup &, const std::string &>
+    [[nodiscard]] std::string Expand(const Lookup &lookup) const {
+        if (slots.empty()) {
+            return literal;
+        }
+
+        std::string out;
+        out.reserve(literal.size());
+        std::size_t done = 0;
+        for (const auto &slot : slots) {
+            out.append(literal, done, slot.offset - done);
+            if (const auto value = lookup(slot.name)) {
+                out += *value;
+            }
+            done = slot.offset;
+        }
+        out.append(literal, done);
+        return out;
+    }
+
+private:
+    struct Slot {
+        // Position in `literal` the value is inserted at
+        std::size_t offset = 0;
+        std::string name;
+    };
+
+    std::string literal;
+    std::vector<Slot> slots;
+};
+
+}  // namespace btft::interpreter
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <memory>
+#include "iparser.h"
+
+namespace btft::parser {
+
+/**
+ * DescentParser - hand-written single-pass parser for grammar/Shell.g4
+ *
+ * Tokens are string_views into the input line and the grammar is walked by
+ * recursive descent without building a parse tree, so the only allocations
+ * are the strings of the resulting PipelineNode. It accepts exactly the
+ * lines the grammar accepts and builds the same PipelineNode as
+ * AntlrParser.
+ *
+ * Lines it can't parse (syntax errors, characters outside the grammar) are
+ * handed to `fallback` untouched, which produces the usual error message.
+ */
+class DescentParser final : public IParser {
+public:
+    explicit DescentParser(std::unique_ptr<IParser> fallback)
+        : fallback(std::move(fallback)) {
+    }
+
+    [[nodiscard]] ParseResult Parse(std::string_view input) const override;
+
+private:
+    std::unique_ptr<IParser> fallback;
+};
+
+}  // namespace btft::parser
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <cstddef>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include "parser/iparser.h"
+
+namespace btft::parser {
+
+/**
+ * ParseCache - remembers the parse results of recently run lines
+ *
+ * Scripts and generated loops run the same lines over and over. Parsing has
+ * no side effects (assignments are AST nodes applied by the executor), so
+ * the result for a line can be shared as is. The cache keeps the
+ * `capacity` most recently used lines and evicts the least recently used
+ * one; capacity 0 turns it off. The `stats` builtin shows the hit rate.
+ */
+class ParseCache final {
+public:
+    static constexpr std::size_t kDefaultCapacity = 256;
+
+    struct Stats {
+        std::size_t hits = 0;
+        std::size_t misses = 0;
+        std::size_t size = 0;
+        std::size_t capacity = 0;
+    };
+
+    static ParseCache &GetInstance() {
+        static ParseCache instance;
+        return instance;
+    }
+
+    // Result for `line`, from the cache or else from `parser`
+    [[nodiscard]] std::shared_ptr<const ParseResult> Parse(
+        std::string_view line,
+        const IParser &parser
+    );
+
+    // Evicts the oldest lines that no longer fit
+    void SetCapacity(std::size_t capacity);
+
+    // Drops all lines and resets the counters
+    void Clear();
+
+    [[nodiscard]] Stats GetStats();
+
+private:
+    using Entry = std::pair<std::string, std::shared_ptr<const ParseResult>>;
+
+    ParseCache() = default;
+
+    ParseCache(const ParseCache &other) = delete;
+    ParseCache(ParseCache &&other) = delete;
+
+    ParseCache &operator=(const ParseCache &other) = delete;
+    ParseCache &operator=(ParseCache &&other) = delete;
+
+    // Drops least recently used lines down to `capacity`; mutex held
+    void Shrink();
+
+    std::mutex mutex;
+    // Most recently used first; `index` keys view the strings in here
+    std::list<Entry> entries;
+    std::unordered_map<std::string_view, std::list<Entry>::iterator> index;
+    std::size_t capacity = kDefaultCapacity;
+    std::size_t hits = 0;
+    std::size_t misses = 0;
+};
+
+}  // namespace btft::parser
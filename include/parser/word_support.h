@@ -0,0 +1,28 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+
+namespace btft::parser {
+
+// Body of a quoted word (without the quotes) with `\<Quote>` turned into
+// `<Quote>`; every other backslash is kept
+template <char Quote>
+    requires(Quote == '\'' || Quote == '"')
+[[nodiscard]] std::string UnescapeQuoted(std::string_view s) {
+    std::string out;
+    out.reserve(s.size());
+    for (std::size_t i = 0; i < s.size(); ++i) {
+        if (s[i] == '\\' && i + 1 < s.size()) {
+            if (const char next = s[i + 1]; next == Quote) {
+                out.push_back(next);
+                ++i;
+                continue;
+            }
+        }
+        out.push_back(s[i]);
+    }
+    return out;
+}
+
+}  // namespace btft::parser
@@ -13,8 +13,17 @@ namespace btft {
 class ShellRepl final {
 public:
     ShellRepl();
+
+    // Interactive loop: prompt, read a line from stdin, run it
     [[nodiscard]] int Run() const;
 
+    // Runs the lines of `script` back to back without prompts; returns the
+    // exit code of the last line
+    [[nodiscard]] int RunScript(std::string_view script) const;
+
+    // RunScript on the whole file at `path`, read in one go
+    [[nodiscard]] int RunFile(const std::string &path) const;
+
 private:
     static void PrintPrompt() {
         std::cout << kPromptPrefix << std::flush;
@@ -26,6 +35,14 @@ private:
         });
     }
 
+    // First non-blank character is '#'
+    static bool IsComment(std::string_view s) noexcept {
+        const auto first = std::ranges::find_if_not(s, [](char c) {
+            return std::isspace(static_cast<unsigned char>(c)) != 0;
+        });
+        return first != s.end() && *first == '#';
+    }
+
     [[nodiscard]] interpreter::ExecutionResult ProcessLine(
         std::string_view raw_input
     ) const;
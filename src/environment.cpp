@@ -1,77 +1,143 @@
 #include <environment.h>
+#include <unordered_set>
 #include <utility>
 
+// NOLINTNEXTLINE(readability-redundant-declaration)
+extern char **environ;
+
 namespace btft {
 
+namespace {
+
+std::optional<std::string> Lookup(
+    const std::unordered_map<std::string, std::string> &vars,
+    const std::string &name
+) {
+    if (const auto it = vars.find(name); it == vars.end()) {
+        return std::nullopt;
+    } else {
+        return it->second;
+    }
+}
+
+}  // namespace
+
+std::vector<std::string> EnvironmentSnapshot::GetEnvironmentArray() const {
+    std::vector<std::string> result;
+    result.reserve(vars.size());
+
+    for (const auto &[key, value] : vars) {
+        std::string entry = key;
+        entry += "=";
+        entry += value;
+        result.push_back(std::move(entry));
+    }
+
+    return result;
+}
+
+char *const *EnvironmentSnapshot::GetEnvp() const {
+    std::call_once(envp_once, [this]() {
+        envp_entries = GetEnvironmentArray();
+
+        std::unordered_set<std::string_view> shadowed;
+        shadowed.reserve(vars.size());
+        for (const auto &[key, value] : vars) {
+            shadowed.insert(key);
+        }
+
+        // The shell never calls setenv, environ stays as it was at startup
+        for (char **var = environ; var != nullptr && *var != nullptr; ++var) {
+            const std::string_view entry(*var);
+            const std::size_t eq_pos = entry.find('=');
+            if (eq_pos != std::string_view::npos &&
+                !shadowed.contains(entry.substr(0, eq_pos))) {
+                envp.push_back(*var);
+            }
+        }
+        for (auto &entry : envp_entries) {
+            envp.push_back(entry.data());
+        }
+        envp.push_back(nullptr);
+    });
+    return envp.data();
+}
+
 void Environment::SetLocal(const std::string &name, const std::string &value) {
+    const std::lock_guard lock(mutex);
     local_vars[name] = value;
+    Touch(name == "PATH");
 }
 
 std::optional<std::string> Environment::GetLocal(const std::string &name
 ) const {
-    if (const auto it = local_vars.find(name); it == local_vars.end()) {
-        return std::nullopt;
-    } else {
-        return it->second;
-    }
+    const std::lock_guard lock(mutex);
+    return Lookup(local_vars, name);
 }
 
 bool Environment::HasLocal(const std::string &name) const {
+    const std::lock_guard lock(mutex);
     return local_vars.contains(name);
 }
 
 void Environment::SetGlobal(const std::string &name, const std::string &value) {
+    const std::lock_guard lock(mutex);
     global_vars[name] = value;
+    Touch(name == "PATH");
 }
 
 std::optional<std::string> Environment::GetGlobal(const std::string &name
 ) const {
-    if (const auto it = global_vars.find(name); it == global_vars.end()) {
-        return std::nullopt;
-    } else {
-        return it->second;
-    }
+    const std::lock_guard lock(mutex);
+    return Lookup(global_vars, name);
 }
 
 bool Environment::HasGlobal(const std::string &name) const {
+    const std::lock_guard lock(mutex);
     return global_vars.contains(name);
 }
 
 bool Environment::HasVar(const std::string &name) const {
-    return HasLocal(name) || HasGlobal(name);
+    const std::lock_guard lock(mutex);
+    return local_vars.contains(name) || global_vars.contains(name);
 }
 
 std::optional<std::string> Environment::GetVar(const std::string &name) const {
-    if (auto local_var = GetLocal(name); local_var) {
+    const std::lock_guard lock(mutex);
+    if (auto local_var = Lookup(local_vars, name); local_var) {
         return local_var;
     }
-    return GetGlobal(name);
+    return Lookup(global_vars, name);
 }
 
 void Environment::ClearLocal() {
+    const std::lock_guard lock(mutex);
+    if (local_vars.empty()) {
+        // Nothing changes, the current snapshot stays valid
+        return;
+    }
+    const bool had_path = local_vars.contains("PATH");
     local_vars.clear();
+    Touch(had_path);
 }
 
 std::vector<std::string> Environment::GetEnvironmentArray() const {
-    std::vector<std::string> result;
-    result.reserve(global_vars.size() + local_vars.size());
-
-    // Add global variables
-    for (const auto &[key, value] : global_vars) {
-        std::string entry = key;
-        entry += "=";
-        entry += value;
-        result.push_back(std::move(entry));
-    }
+    return GetSnapshot()->GetEnvironmentArray();
+}
 
-    // Add local variables (they override globals if same key exists)
-    for (const auto &[key, value] : local_vars) {
-        std::string entry = key;
-        entry += "=";
-        entry += value;
-        result.push_back(std::move(entry));
+std::shared_ptr<const EnvironmentSnapshot> Environment::GetSnapshot() const {
+    const std::lock_guard lock(mutex);
+    if (!snapshot) {
+        // Locals override globals of the same name
+        std::unordered_map<std::string, std::string> vars = global_vars;
+        for (const auto &[key, value] : local_vars) {
+            vars.insert_or_assign(key, value);
+        }
+        snapshot = std::make_shared<const EnvironmentSnapshot>(
+            std::move(vars), version, path_version
+        );
     }
-
-    return result;
+    return snapshot;
 }
+
 }  // namespace btft
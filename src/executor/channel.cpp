@@ -1,32 +1,62 @@
 #include "executor/channel.h"
-#include <iostream>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
 
 namespace btft::interpreter::executor {
 
+Channel::Channel(std::size_t capacity)
+    : ring(std::max<std::size_t>(capacity, 1)) {
+}
+
 void Channel::Write(const std::string &buffer) {
-    const std::unique_lock mutex_write(mutex);
-    if (closed) {
-        throw std::runtime_error("Channel is closed, you can't write into it");
+    std::size_t written = 0;
+    while (written < buffer.size()) {
+        std::unique_lock mutex_write(mutex);
+        not_full.wait(mutex_write, [this]() {
+            return closed || size < ring.size();
+        });
+        if (closed) {
+            throw ChannelClosedError(
+                "Channel is closed, you can't write into it"
+            );
+        }
+
+        // Copy as much as fits, in at most two pieces around the ring end
+        const std::size_t count =
+            std::min(buffer.size() - written, ring.size() - size);
+        const std::size_t tail = (head + size) % ring.size();
+        const std::size_t first = std::min(count, ring.size() - tail);
+        std::copy_n(buffer.data() + written, first, ring.data() + tail);
+        std::copy_n(buffer.data() + written + first, count - first, ring.data());
+
+        size += count;
+        written += count;
+        not_empty.notify_one();
     }
-    readBuffer << buffer;
-    condVar.notify_all();
 }
 
 std::string Channel::Read() {
     std::unique_lock mutex_read(mutex);
-    condVar.wait(mutex_read, [this]() {
-        return closed || !readBuffer.str().empty();
-    });
+    not_empty.wait(mutex_read, [this]() { return closed || size > 0; });
+
+    std::string result(size, '\0');
+    const std::size_t first = std::min(size, ring.size() - head);
+    std::copy_n(ring.data() + head, first, result.data());
+    std::copy_n(ring.data(), size - first, result.data() + first);
 
-    std::string result = std::move(readBuffer.str());
-    readBuffer.str("");
+    head = (head + size) % ring.size();
+    size = 0;
+    not_full.notify_one();
     return result;
 }
 
 void Channel::CloseChannel() {
     const std::unique_lock mutex_close(mutex);
     closed = true;
-    condVar.notify_all();
+    not_empty.notify_all();
+    not_full.notify_all();
 }
 
 bool Channel::IsClosed() const {
@@ -35,24 +65,170 @@ bool Channel::IsClosed() const {
 }
 
 std::string InputStdChannel::Read() {
-    std::string result;
-    std::getline(std::cin, result);
-    result += "\n";
-    return result;
+    if (begin == end && !Fill()) {
+        return {};
+    }
+    // Only the bytes actually there are copied out
+    std::string chunk(buffer.data() + begin, end - begin);
+    begin = end = 0;
+    return chunk;
+}
+
+bool InputStdChannel::ReadLine(std::string &line) {
+    std::size_t searched = begin;
+    while (true) {
+        const char *data = buffer.data();
+        const void *newline =
+            std::memchr(data + searched, '\n', end - searched);
+        if (newline != nullptr) {
+            const auto at = static_cast<std::size_t>(
+                static_cast<const char *>(newline) - data
+            );
+            line.assign(data + begin, at - begin);
+            begin = at + 1;
+            return true;
+        }
+
+        // Fill moves the unread part to the front of the buffer
+        searched = end - begin;
+        if (!Fill()) {
+            if (begin == end) {
+                return false;
+            }
+            line.assign(buffer.data() + begin, end - begin);
+            begin = end = 0;
+            return true;
+        }
+    }
+}
+
+bool InputStdChannel::Fill() {
+    if (eof) {
+        return false;
+    }
+    if (buffer.empty()) {
+        buffer.resize(kBlockSize);
+    }
+    if (begin == end) {
+        begin = end = 0;
+    } else if (begin != 0) {
+        std::memmove(buffer.data(), buffer.data() + begin, end - begin);
+        end -= begin;
+        begin = 0;
+    }
+    if (end == buffer.size()) {
+        // A line longer than the buffer
+        buffer.resize(buffer.size() * 2);
+    }
+
+    while (true) {
+        const ssize_t count =
+            ::read(STDIN_FILENO, buffer.data() + end, buffer.size() - end);
+        if (count < 0 && errno == EINTR) {
+            continue;
+        }
+        if (count <= 0) {
+            eof = true;
+            return false;
+        }
+        end += static_cast<std::size_t>(count);
+        return true;
+    }
 }
 
 bool InputStdChannel::IsClosed() const {
-    return std::cin.eof();
+    return eof && begin == end;
 }
 
 void InputStdChannel::CloseChannel() {
 }
 
+void InputStdChannel::ReturnUnread() {
+    if (begin == end) {
+        return;
+    }
+    const auto unread = static_cast<off_t>(end - begin);
+    if (::lseek(STDIN_FILENO, -unread, SEEK_CUR) >= 0) {
+        begin = end = 0;
+        eof = false;
+    }
+}
+
+std::optional<int> InputStdChannel::GetFd() const {
+    return STDIN_FILENO;
+}
+
+namespace {
+
+void WriteAll(int fd, const char *data, std::size_t size) {
+    std::size_t written = 0;
+    while (written < size) {
+        const ssize_t count = ::write(fd, data + written, size - written);
+        if (count < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw ChannelClosedError(std::strerror(errno));
+        }
+        written += static_cast<std::size_t>(count);
+    }
+}
+
+}  // namespace
+
+OutputStdChannel::OutputStdChannel()
+    : line_buffered(::isatty(STDOUT_FILENO) != 0) {
+    pending.reserve(kBufferSize);
+}
+
+OutputStdChannel::~OutputStdChannel() {
+    try {
+        Flush();
+    } catch (const ChannelClosedError &) {
+        // Nobody is reading stdout any more
+    }
+}
+
 void OutputStdChannel::Write(const std::string &buffer) {
-    std::cout << buffer;
+    const std::lock_guard lock(mutex);
+    if (pending.size() + buffer.size() > kBufferSize) {
+        FlushPending();
+        if (buffer.size() >= kBufferSize) {
+            // Too big to be worth copying, it goes out on its own
+            WriteAll(STDOUT_FILENO, buffer.data(), buffer.size());
+            return;
+        }
+    }
+
+    pending += buffer;
+    if (line_buffered && buffer.find('\n') != std::string::npos) {
+        FlushPending();
+    }
+}
+
+void OutputStdChannel::Flush() {
+    const std::lock_guard lock(mutex);
+    FlushPending();
+}
+
+void OutputStdChannel::FlushPending() {
+    if (pending.empty()) {
+        return;
+    }
+    try {
+        WriteAll(STDOUT_FILENO, pending.data(), pending.size());
+    } catch (const ChannelClosedError &) {
+        pending.clear();
+        throw;
+    }
+    pending.clear();
 }
 
 void OutputStdChannel::CloseChannel() {
 }
 
+std::optional<int> OutputStdChannel::GetFd() const {
+    return STDOUT_FILENO;
+}
+
 }  // namespace btft::interpreter::executor
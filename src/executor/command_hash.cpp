@@ -0,0 +1,144 @@
+#include "executor/command_hash.h"
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cstdlib>
+#include <string_view>
+#include "environment.h"
+
+namespace btft::interpreter::executor {
+
+namespace {
+
+bool IsExecutable(const std::string &path) {
+    struct stat file_stat {};
+    return ::stat(path.c_str(), &file_stat) == 0 &&
+           S_ISREG(file_stat.st_mode) && ::access(path.c_str(), X_OK) == 0;
+}
+
+// The shell's PATH, or the one the shell itself was started with
+std::string GetSearchPath(const EnvironmentSnapshot &env) {
+    if (const std::string *path = env.Find("PATH")) {
+        return *path;
+    }
+    // NOLINTNEXTLINE(concurrency-mt-unsafe)
+    if (const char *path = std::getenv("PATH")) {
+        return path;
+    }
+    return "/usr/bin:/bin";
+}
+
+// The walk execvp does, one stat per PATH entry
+std::optional<std::string> SearchPath(
+    const std::string &name,
+    const EnvironmentSnapshot &env
+) {
+    const std::string path = GetSearchPath(env);
+    std::string_view rest = path;
+    while (true) {
+        const std::size_t colon = rest.find(':');
+        std::string_view dir = rest.substr(0, colon);
+        if (dir.empty()) {
+            // An empty PATH entry means the current directory
+            dir = ".";
+        }
+
+        std::string candidate(dir);
+        candidate += '/';
+        candidate += name;
+        if (IsExecutable(candidate)) {
+            return candidate;
+        }
+
+        if (colon == std::string_view::npos) {
+            return std::nullopt;
+        }
+        rest.remove_prefix(colon + 1);
+    }
+}
+
+}  // namespace
+
+std::optional<std::string> CommandHash::Resolve(
+    const std::string &name,
+    const EnvironmentSnapshot &env
+) {
+    if (name.find('/') != std::string::npos) {
+        return name;
+    }
+
+    {
+        const std::lock_guard lock(mutex);
+        Validate(env);
+        if (const auto it = table.find(name); it != table.end()) {
+            ++it->second.hits;
+            return it->second.path;
+        }
+    }
+
+    std::optional<std::string> path = Rehash(name, env);
+    if (path) {
+        const std::lock_guard lock(mutex);
+        if (const auto it = table.find(name); it != table.end()) {
+            ++it->second.hits;
+        }
+    }
+    return path;
+}
+
+std::optional<std::string> CommandHash::Rehash(
+    const std::string &name,
+    const EnvironmentSnapshot &env
+) {
+    if (name.find('/') != std::string::npos) {
+        return name;
+    }
+
+    std::optional<std::string> path = SearchPath(name, env);
+
+    const std::lock_guard lock(mutex);
+    Validate(env);
+    if (!path) {
+        table.erase(name);
+        return std::nullopt;
+    }
+    Entry &entry = table[name];
+    entry.name = name;
+    entry.path = *path;
+    return path;
+}
+
+void CommandHash::Forget(const std::string &name) {
+    const std::lock_guard lock(mutex);
+    table.erase(name);
+}
+
+void CommandHash::Clear() {
+    const std::lock_guard lock(mutex);
+    table.clear();
+}
+
+std::vector<CommandHash::Entry> CommandHash::GetEntries(
+    const EnvironmentSnapshot &env
+) {
+    const std::lock_guard lock(mutex);
+    Validate(env);
+
+    std::vector<Entry> entries;
+    entries.reserve(table.size());
+    for (const auto &[name, entry] : table) {
+        entries.push_back(entry);
+    }
+    std::ranges::sort(entries, {}, &Entry::name);
+    return entries;
+}
+
+void CommandHash::Validate(const EnvironmentSnapshot &env) {
+    const std::uint64_t version = env.GetPathVersion();
+    if (version != path_version) {
+        table.clear();
+        path_version = version;
+    }
+}
+
+}  // namespace btft::interpreter::executor
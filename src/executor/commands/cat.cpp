@@ -1,9 +1,178 @@
 #include "executor/commands/cat.h"
-#include <fstream>
-#include <iostream>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+#include <optional>
+#include <string_view>
+#include <utility>
+#include "executor/mapped_file.h"
+#include "executor/scoped_fd.h"
+#if defined(__linux__)
+#include <sys/sendfile.h>
+#endif
 
 namespace btft::interpreter::executor::commands {
 
+namespace {
+
+constexpr std::size_t kReadChunkSize = 64 * 1024;
+
+// Upper bound for a single splice(2)/sendfile(2) call
+constexpr std::size_t kTransferChunkSize = 1024 * 1024;
+
+enum class CopyStatus {
+    kDone,
+    kUnsupported,
+    kFailed,
+};
+
+[[noreturn]] void ThrowBrokenOutput() {
+    throw ChannelClosedError(std::strerror(errno));
+}
+
+// Moves the whole file into `out_fd` without copying it through user space:
+// splice(2) when the output is a pipe, sendfile(2) otherwise. Reports
+// kUnsupported if the kernel refuses this pair of descriptors before any
+// data was moved.
+CopyStatus KernelCopy(
+    [[maybe_unused]] int in_fd,
+    [[maybe_unused]] int out_fd
+) {
+#if defined(__linux__)
+    struct stat out_stat {};
+    const bool to_pipe =
+        ::fstat(out_fd, &out_stat) == 0 && S_ISFIFO(out_stat.st_mode);
+
+    bool moved_any = false;
+    while (true) {
+        const ssize_t count =
+            to_pipe ? ::splice(
+                          in_fd, nullptr, out_fd, nullptr, kTransferChunkSize,
+                          SPLICE_F_MOVE
+                      )
+                    : ::sendfile(out_fd, in_fd, nullptr, kTransferChunkSize);
+        if (count > 0) {
+            moved_any = true;
+            continue;
+        }
+        if (count == 0) {
+            return CopyStatus::kDone;
+        }
+        if (errno == EINTR) {
+            continue;
+        }
+        if (errno == EPIPE) {
+            ThrowBrokenOutput();
+        }
+        if (!moved_any && (errno == EINVAL || errno == ENOSYS)) {
+            return CopyStatus::kUnsupported;
+        }
+        return CopyStatus::kFailed;
+    }
+#else
+    return CopyStatus::kUnsupported;
+#endif
+}
+
+// Maps regular files big enough for mmap(2) to beat read(2)
+std::optional<MappedFile> MapIfLarge(int fd) {
+    struct stat file_stat {};
+    if (::fstat(fd, &file_stat) != 0 || !S_ISREG(file_stat.st_mode) ||
+        static_cast<std::size_t>(file_stat.st_size) < MappedFile::kMinSize) {
+        return std::nullopt;
+    }
+    return MappedFile::Map(fd, static_cast<std::size_t>(file_stat.st_size));
+}
+
+// False if `data` itself could not be read: EFAULT from a mapped file
+// that was truncated underneath us
+bool WriteAll(int out_fd, std::string_view data) {
+    while (!data.empty()) {
+        const ssize_t n = ::write(out_fd, data.data(), data.size());
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno == EFAULT) {
+                return false;
+            }
+            ThrowBrokenOutput();
+        }
+        data.remove_prefix(static_cast<std::size_t>(n));
+    }
+    return true;
+}
+
+// Plain read(2)/write(2) loop for descriptors the kernel can't splice;
+// large regular files are written straight from a mapping instead
+CopyStatus BufferedCopy(int in_fd, int out_fd) {
+    if (const auto mapping = MapIfLarge(in_fd)) {
+        return WriteAll(out_fd, mapping->View()) ? CopyStatus::kDone
+                                                 : CopyStatus::kFailed;
+    }
+
+    std::string buffer(kReadChunkSize, '\0');
+    while (true) {
+        const ssize_t count = ::read(in_fd, buffer.data(), buffer.size());
+        if (count == 0) {
+            return CopyStatus::kDone;
+        }
+        if (count < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return CopyStatus::kFailed;
+        }
+        if (!WriteAll(
+                out_fd, std::string_view(
+                            buffer.data(), static_cast<std::size_t>(count)
+                        )
+            )) {
+            return CopyStatus::kFailed;
+        }
+    }
+}
+
+// Hands the file over to an in-process channel, one fresh chunk at a time
+CopyStatus CopyToChannel(int in_fd, IOutputChannel &output_channel) {
+    if (const auto mapping = MapIfLarge(in_fd)) {
+        std::string_view rest = mapping->View();
+        while (!rest.empty()) {
+            const std::string_view piece = rest.substr(0, kReadChunkSize);
+            std::string chunk(piece.size(), '\0');
+            // A file truncated since it was mapped fails like a read error
+            if (!MappedFile::Guarded([&chunk, &piece]() {
+                    std::memcpy(chunk.data(), piece.data(), piece.size());
+                })) {
+                return CopyStatus::kFailed;
+            }
+            output_channel.Write(std::move(chunk));
+            rest.remove_prefix(piece.size());
+        }
+        return CopyStatus::kDone;
+    }
+
+    while (true) {
+        std::string chunk(kReadChunkSize, '\0');
+        const ssize_t count = ::read(in_fd, chunk.data(), chunk.size());
+        if (count == 0) {
+            return CopyStatus::kDone;
+        }
+        if (count < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return CopyStatus::kFailed;
+        }
+        chunk.resize(static_cast<std::size_t>(count));
+        output_channel.Write(std::move(chunk));
+    }
+}
+
+}  // namespace
+
 ExecutionResult CatCommand::Execute(
     const std::vector<std::string> &args,
     std::shared_ptr<IInputChannel> input_channel,
@@ -11,29 +180,63 @@ ExecutionResult CatCommand::Execute(
 ) {
     if (args.empty()) {
         while (true) {
-            const std::string chunk = input_channel->Read();
+            std::string chunk = input_channel->Read();
             if (chunk.empty() && input_channel->IsClosed()) {
                 break;
             }
-            output_channel->Write(chunk);
+            output_channel->Write(std::move(chunk));
         }
         return ExecutionResult{};
     }
 
+    // Output that ends up in a descriptor (a kernel pipe or stdout) is
+    // written there directly, bypassing the channel
+    const std::optional<int> out_fd = output_channel->GetFd();
+    if (out_fd) {
+        output_channel->Flush();
+    }
+
     for (const auto &filename : args) {
-        std::ifstream file(filename);
-        if (!file.is_open()) {
+        const ScopedFd file(::open(filename.c_str(), O_RDONLY | O_CLOEXEC));
+        if (!file.IsValid()) {
             return ExecutionResult{.exit_code = 1};
         }
 
-        std::string line;
-        while (std::getline(file, line)) {
-            output_channel->Write(line + "\n");
+        CopyStatus status = CopyStatus::kUnsupported;
+        if (out_fd) {
+            status = KernelCopy(file.Get(), *out_fd);
+            if (status == CopyStatus::kUnsupported) {
+                status = BufferedCopy(file.Get(), *out_fd);
+            }
+        } else {
+            status = CopyToChannel(file.Get(), *output_channel);
+        }
+
+        if (status != CopyStatus::kDone) {
+            return ExecutionResult{.exit_code = 1};
         }
-        file.close();
     }
 
     return ExecutionResult{};
 }
 
+StageTask CatCommand::ExecuteCooperative(
+    const std::vector<std::string> &args,
+    CooperativeChannel &input,
+    std::shared_ptr<IOutputChannel> output
+) {
+    if (!args.empty()) {
+        co_return Execute(args, input.AsInputChannel(), std::move(output));
+    }
+
+    while (true) {
+        std::string chunk = co_await input.Read();
+        if (chunk.empty() && input.IsClosed()) {
+            break;
+        }
+        output->Write(std::move(chunk));
+    }
+    co_return ExecutionResult{};
+}
+
 }  // namespace btft::interpreter::executor::commands
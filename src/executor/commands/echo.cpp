@@ -1,4 +1,5 @@
 #include "executor/commands/echo.h"
+#include <utility>
 
 namespace btft::interpreter::executor::commands {
 
@@ -7,13 +8,22 @@ ExecutionResult EchoCommand::Execute(
     std::shared_ptr<IInputChannel> /*input_channel*/,
     std::shared_ptr<IOutputChannel> output_channel
 ) {
+    std::size_t length = args.size() + 1;
+    for (const auto &arg : args) {
+        length += arg.size();
+    }
+
+    // Build the whole line first, so it travels as a single chunk
+    std::string line;
+    line.reserve(length);
     for (std::size_t i = 0; i < args.size(); ++i) {
-        output_channel->Write(args[i]);
+        line += args[i];
         if (i != args.size() - 1) {
-            output_channel->Write(" ");
+            line += ' ';
         }
     }
-    output_channel->Write("\n");
+    line += '\n';
+    output_channel->Write(std::move(line));
 
     return ExecutionResult{};
 }
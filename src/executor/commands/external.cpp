@@ -1,72 +1,200 @@
 #include "executor/commands/external.h"
+#include <spawn.h>
 #include <sys/wait.h>
 #include <unistd.h>
-#include <cstdlib>
+#include <cerrno>
+#include <csignal>
+#include <cstring>
 #include <iostream>
-#include "environment.h"
+#include <optional>
+#include <thread>
+#include <tuple>
+#include <utility>
+#include "executor/command_hash.h"
+#include "executor/fd_channel.h"
 
 namespace btft::interpreter::executor::commands {
 
+namespace {
+
+// Copies everything from `from` into `to` until either side is done
+void Relay(IInputChannel &from, IOutputChannel &to) {
+    try {
+        while (true) {
+            std::string chunk = from.Read();
+            if (chunk.empty() && from.IsClosed()) {
+                break;
+            }
+            to.Write(std::move(chunk));
+        }
+    } catch (const ChannelClosedError &) {
+        // The receiving side went away, drop the rest
+    }
+}
+
+// Starts `path` with the given stdin/stdout; returns 0 or an errno value
+int Spawn(
+    const std::string &path,
+    const std::vector<char *> &argv,
+    char *const *envp,
+    int stdin_fd,
+    int stdout_fd,
+    pid_t &pid
+) {
+    posix_spawn_file_actions_t actions;
+    posix_spawn_file_actions_init(&actions);
+    if (stdin_fd != STDIN_FILENO) {
+        posix_spawn_file_actions_adddup2(&actions, stdin_fd, STDIN_FILENO);
+    }
+    if (stdout_fd != STDOUT_FILENO) {
+        posix_spawn_file_actions_adddup2(&actions, stdout_fd, STDOUT_FILENO);
+    }
+
+    // The shell ignores SIGPIPE, programs expect the default action
+    posix_spawnattr_t attributes;
+    posix_spawnattr_init(&attributes);
+    sigset_t default_signals;
+    sigemptyset(&default_signals);
+    sigaddset(&default_signals, SIGPIPE);
+    posix_spawnattr_setsigdefault(&attributes, &default_signals);
+    posix_spawnattr_setflags(&attributes, POSIX_SPAWN_SETSIGDEF);
+
+    const int error = posix_spawn(
+        &pid, path.c_str(), &actions, &attributes, argv.data(), envp
+    );
+
+    posix_spawnattr_destroy(&attributes);
+    posix_spawn_file_actions_destroy(&actions);
+    return error;
+}
+
+}  // namespace
+
 ExecutionResult ExternalCommand::Execute(
     const std::vector<std::string> &args,
-    std::shared_ptr<IInputChannel> /*input_channel*/,
-    std::shared_ptr<IOutputChannel> /*output_channel*/
+    std::shared_ptr<IInputChannel> input_channel,
+    std::shared_ptr<IOutputChannel> output_channel
+) {
+    return Execute(
+        *Environment::GetInstance().GetSnapshot(), args,
+        std::move(input_channel), std::move(output_channel)
+    );
+}
+
+ExecutionResult ExternalCommand::Execute(
+    const EnvironmentSnapshot &env,
+    const std::vector<std::string> &args,
+    std::shared_ptr<IInputChannel> input_channel,
+    std::shared_ptr<IOutputChannel> output_channel
 ) {
     if (args.empty()) {
         return ExecutionResult{.exit_code = 1, .should_exit = false};
     }
 
-    const pid_t pid = fork();
-    if (pid == -1) {
-        return ExecutionResult{.exit_code = 1, .should_exit = false};
+    // Everything the child needs is prepared up front: posix_spawn only
+    // rearranges descriptors and execs, no allocations or setenv in the
+    // child, and no copy-on-write faults from fork(2)
+    auto &command_hash = CommandHash::GetInstance();
+    std::optional<std::string> path = command_hash.Resolve(args[0], env);
+    if (!path) {
+        std::cerr << args[0] << ": command not found\n";
+        return ExecutionResult{.exit_code = 127, .should_exit = false};
     }
 
-    if (pid == 0) {
-        // Prepare argv
-        std::vector<char *> argv;
-        argv.reserve(args.size() + 1);
-        for (const auto &arg : args) {
-            // NOLINTNEXTLINE(cppcoreguidelines-pro-type-const-cast)
-            argv.push_back(const_cast<char *>(arg.c_str()));
+    std::vector<char *> argv;
+    argv.reserve(args.size() + 1);
+    for (const auto &arg : args) {
+        // NOLINTNEXTLINE(cppcoreguidelines-pro-type-const-cast)
+        argv.push_back(const_cast<char *>(arg.c_str()));
+    }
+    argv.push_back(nullptr);
+
+    // Built once per snapshot and shared by every launch until a variable
+    // changes
+    char *const *envp = env.GetEnvp();
+
+    // Channels backed by a descriptor are handed to the child as is, the
+    // in-process ones are bridged through a pipe and a relay
+    std::optional<int> stdin_fd = input_channel->GetFd();
+    std::shared_ptr<FdInputChannel> stdin_pipe_read;
+    std::shared_ptr<FdOutputChannel> stdin_pipe_write;
+    if (!stdin_fd) {
+        std::tie(stdin_pipe_read, stdin_pipe_write) = MakePipe();
+        stdin_fd = stdin_pipe_read->GetFd();
+    }
+
+    std::optional<int> stdout_fd = output_channel->GetFd();
+    std::shared_ptr<FdInputChannel> stdout_pipe_read;
+    std::shared_ptr<FdOutputChannel> stdout_pipe_write;
+    if (!stdout_fd) {
+        std::tie(stdout_pipe_read, stdout_pipe_write) = MakePipe();
+        stdout_fd = stdout_pipe_write->GetFd();
+    } else {
+        output_channel->Flush();
+    }
+
+    pid_t pid = -1;
+    int error = Spawn(*path, argv, envp, *stdin_fd, *stdout_fd, pid);
+    if (error == ENOENT && args[0].find('/') == std::string::npos) {
+        // The remembered file is gone, look it up again like bash does
+        path = command_hash.Rehash(args[0], env);
+        if (path) {
+            error = Spawn(*path, argv, envp, *stdin_fd, *stdout_fd, pid);
         }
-        argv.push_back(nullptr);
-
-        // Set environment variables
-        auto &env = Environment::GetInstance();
-        const std::vector<std::string> env_strings = env.GetEnvironmentArray();
-        for (const auto &env_str : env_strings) {
-            // Parse KEY=VALUE
-            const size_t eq_pos = env_str.find('=');
-            if (eq_pos != std::string::npos) {
-                const std::string key = env_str.substr(0, eq_pos);
-                const std::string value = env_str.substr(eq_pos + 1);
-                // NOLINTNEXTLINE(concurrency-mt-unsafe)
-                setenv(key.c_str(), value.c_str(), 1);
-            }
+    }
+    if (error != 0) {
+        if (error == ENOENT) {
+            std::cerr << args[0] << ": command not found\n";
+            return ExecutionResult{.exit_code = 127, .should_exit = false};
         }
+        std::cerr << args[0] << ": " << std::strerror(error) << "\n";
+        return ExecutionResult{.exit_code = 126, .should_exit = false};
+    }
 
-        // Execute with PATH search
-        execvp(args[0].c_str(), argv.data());
-
-        // If execvp returns, it failed
-        std::cerr << args[0] << ": command not found\n";
-        // NOLINTNEXTLINE(concurrency-mt-unsafe)
-        std::exit(127);
+    // Only the child may keep these ends open, otherwise its neighbours
+    // never see end of file or a broken pipe
+    if (stdin_pipe_read) {
+        stdin_pipe_read->CloseChannel();
     } else {
-        int status = 0;
-        waitpid(pid, &status, 0);
+        input_channel->CloseChannel();
+    }
+    if (stdout_pipe_write) {
+        stdout_pipe_write->CloseChannel();
+    }
 
-        ExecutionResult result;
-        result.should_exit = false;
+    std::thread feeder;
+    if (stdin_pipe_write) {
+        feeder = std::thread([&input_channel, &stdin_pipe_write]() {
+            Relay(*input_channel, *stdin_pipe_write);
+            stdin_pipe_write->CloseChannel();
+            input_channel->CloseChannel();
+        });
+    }
+    if (stdout_pipe_read) {
+        Relay(*stdout_pipe_read, *output_channel);
+        stdout_pipe_read->CloseChannel();
+    }
 
-        if (WIFEXITED(status)) {
-            result.exit_code = WEXITSTATUS(status);
-        } else {
-            result.exit_code = 1;
-        }
+    int status = 0;
+    waitpid(pid, &status, 0);
+    if (feeder.joinable()) {
+        feeder.join();
+    }
+
+    ExecutionResult result;
+    result.should_exit = false;
 
-        return result;
+    if (WIFEXITED(status)) {
+        result.exit_code = WEXITSTATUS(status);
+    } else if (WIFSIGNALED(status) && WTERMSIG(status) == SIGPIPE) {
+        // Killed because the next stage stopped reading, the same quiet
+        // end builtins get through ChannelClosedError
+        result.exit_code = 0;
+    } else {
+        result.exit_code = 1;
     }
+
+    return result;
 }
 
 }  // namespace btft::interpreter::executor::commands
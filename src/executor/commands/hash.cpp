@@ -0,0 +1,61 @@
+#include "executor/commands/hash.h"
+#include <iostream>
+#include <string>
+#include "environment.h"
+#include "executor/command_hash.h"
+
+namespace btft::interpreter::executor::commands {
+
+namespace {
+
+std::string FormatHits(std::size_t hits) {
+    std::string text = std::to_string(hits);
+    constexpr std::size_t kWidth = 4;
+    if (text.size() < kWidth) {
+        text.insert(0, kWidth - text.size(), ' ');
+    }
+    return text;
+}
+
+}  // namespace
+
+ExecutionResult HashCommand::Execute(
+    const std::vector<std::string> &args,
+    std::shared_ptr<IInputChannel> /*input_channel*/,
+    std::shared_ptr<IOutputChannel> output_channel
+) {
+    auto &command_hash = CommandHash::GetInstance();
+    const auto env = Environment::GetInstance().GetSnapshot();
+
+    if (args.empty()) {
+        const std::vector<CommandHash::Entry> entries =
+            command_hash.GetEntries(*env);
+        if (entries.empty()) {
+            output_channel->Write(std::string("hash: hash table empty\n"));
+            return ExecutionResult{};
+        }
+
+        std::string table = "hits\tcommand\n";
+        for (const auto &entry : entries) {
+            table += FormatHits(entry.hits);
+            table += '\t';
+            table += entry.path;
+            table += '\n';
+        }
+        output_channel->Write(std::move(table));
+        return ExecutionResult{};
+    }
+
+    ExecutionResult result{};
+    for (const auto &arg : args) {
+        if (arg == "-r") {
+            command_hash.Clear();
+        } else if (!command_hash.Rehash(arg, *env)) {
+            std::cerr << "hash: " << arg << ": not found\n";
+            result.exit_code = 1;
+        }
+    }
+    return result;
+}
+
+}  // namespace btft::interpreter::executor::commands
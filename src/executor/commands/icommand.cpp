@@ -0,0 +1,13 @@
+#include "executor/commands/icommand.h"
+
+namespace btft::interpreter::executor::commands {
+
+StageTask ICommand::ExecuteCooperative(
+    const std::vector<std::string> &args,
+    CooperativeChannel &input,
+    std::shared_ptr<IOutputChannel> output
+) {
+    co_return Execute(args, input.AsInputChannel(), std::move(output));
+}
+
+}  // namespace btft::interpreter::executor::commands
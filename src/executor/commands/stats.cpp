@@ -0,0 +1,53 @@
+#include "executor/commands/stats.h"
+#include <iostream>
+#include <string>
+#include "parser/parse_cache.h"
+
+namespace btft::interpreter::executor::commands {
+
+namespace {
+
+// Percentage with one decimal, "0.0%" before the first lookup
+std::string FormatRate(std::size_t hits, std::size_t total) {
+    const std::size_t per_mille = total == 0 ? 0 : hits * 1000 / total;
+    return std::to_string(per_mille / 10) + "." +
+           std::to_string(per_mille % 10) + "%";
+}
+
+}  // namespace
+
+ExecutionResult StatsCommand::Execute(
+    const std::vector<std::string> &args,
+    std::shared_ptr<IInputChannel> /*input_channel*/,
+    std::shared_ptr<IOutputChannel> output_channel
+) {
+    auto &parse_cache = parser::ParseCache::GetInstance();
+
+    for (const auto &arg : args) {
+        if (arg != "-r") {
+            std::cerr << "stats: " << arg << ": invalid option\n";
+            return ExecutionResult{.exit_code = 1};
+        }
+    }
+    if (!args.empty()) {
+        parse_cache.Clear();
+        return ExecutionResult{};
+    }
+
+    const parser::ParseCache::Stats stats = parse_cache.GetStats();
+    if (stats.capacity == 0) {
+        output_channel->Write(std::string("parse cache: disabled\n"));
+        return ExecutionResult{};
+    }
+
+    output_channel->Write(
+        "parse cache: " + std::to_string(stats.hits) + " hits, " +
+        std::to_string(stats.misses) + " misses, " +
+        FormatRate(stats.hits, stats.hits + stats.misses) + " hit rate, " +
+        std::to_string(stats.size) + "/" + std::to_string(stats.capacity) +
+        " lines\n"
+    );
+    return ExecutionResult{};
+}
+
+}  // namespace btft::interpreter::executor::commands
@@ -1,38 +1,203 @@
 #include <executor/commands/wc.h>
-#include <fstream>
-#include <iostream>
-#include <sstream>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <iterator>
+#include <optional>
+#include <string_view>
+#include <thread>
+#include "executor/commands/wc_stats.h"
+#include "executor/mapped_file.h"
+#include "executor/scoped_fd.h"
 
 namespace btft::interpreter::executor::commands {
 
 namespace {
 
-std::tuple<std::size_t, std::size_t, std::size_t> CountStats(
-    const std::string &content
+// Regular files larger than this are split between worker threads
+constexpr std::size_t kSplitChunkSize = 8 * 1024 * 1024;
+constexpr std::size_t kReadBufferSize = 1024 * 1024;
+
+// A byte range of one file; `sequential` tasks read the descriptor to its
+// end instead (pipes, character devices, /proc files reporting size 0)
+struct CountTask {
+    std::size_t file = 0;
+    off_t offset = 0;
+    std::size_t length = 0;
+    bool sequential = false;
+};
+
+struct InputFile {
+    ScopedFd fd;
+    // Set for regular files of at least MappedFile::kMinSize bytes
+    std::optional<MappedFile> mapping;
+    // Counted as empty, like wc always did; gets no tasks
+    bool directory = false;
+};
+
+struct CountResult {
+    TextStats stats;
+    bool starts_in_word = false;
+    bool ends_in_word = false;
+    bool ok = true;
+};
+
+// Counts a range straight from the mapping, no copies involved
+CountResult CountMapped(const CountTask &task, const MappedFile &mapping) {
+    const std::string_view range = mapping.View().substr(
+        static_cast<std::size_t>(task.offset), task.length
+    );
+
+    CountResult result;
+    if (range.empty()) {
+        return result;
+    }
+    bool in_word = false;
+    // A file truncated since it was mapped fails like a read error
+    result.ok = MappedFile::Guarded([&result, &range, &in_word]() {
+        result.starts_in_word =
+            !IsWhitespace(static_cast<unsigned char>(range.front()));
+        result.stats = CountStats(range, in_word);
+    });
+    result.ends_in_word = in_word;
+    return result;
+}
+
+CountResult RunTask(
+    const CountTask &task,
+    const InputFile &file,
+    std::string &buffer
 ) {
-    std::size_t lines = 0;
-    std::size_t words = 0;
-    const std::size_t bytes = content.size();
+    if (file.mapping && !task.sequential) {
+        return CountMapped(task, *file.mapping);
+    }
 
+    CountResult result;
+    const int fd = file.fd.Get();
     bool in_word = false;
-    for (const char c : content) {
-        if (c == '\n') {
-            lines++;
+    std::size_t done = 0;
+
+    while (task.sequential || done < task.length) {
+        const std::size_t want =
+            task.sequential ? buffer.size()
+                            : std::min(buffer.size(), task.length - done);
+        const ssize_t count =
+            task.sequential
+                ? ::read(fd, buffer.data(), want)
+                : ::pread(
+                      fd, buffer.data(), want,
+                      task.offset + static_cast<off_t>(done)
+                  );
+        if (count < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            result.ok = false;
+            break;
         }
-        if (std::isspace(static_cast<unsigned char>(c)) != 0) {
-            if (in_word) {
-                words++;
-                in_word = false;
+        if (count == 0) {
+            break;
+        }
+
+        if (done == 0) {
+            result.starts_in_word =
+                !IsWhitespace(static_cast<unsigned char>(buffer.front()));
+        }
+        result.stats += CountStats(
+            std::string_view(buffer.data(), static_cast<std::size_t>(count)),
+            in_word
+        );
+        done += static_cast<std::size_t>(count);
+    }
+
+    result.ends_in_word = in_word;
+    return result;
+}
+
+// Runs all tasks on up to hardware_concurrency threads; a single task is
+// counted on the calling thread
+std::vector<CountResult> RunTasks(
+    const std::vector<CountTask> &tasks,
+    const std::vector<InputFile> &files
+) {
+    std::vector<CountResult> results(tasks.size());
+    std::atomic<std::size_t> next_task{0};
+
+    const auto worker = [&tasks, &files, &results, &next_task]() {
+        std::string buffer;
+        for (std::size_t i = next_task++; i < tasks.size(); i = next_task++) {
+            if (buffer.empty() && !files[tasks[i].file].mapping) {
+                buffer.resize(kReadBufferSize);
             }
-        } else {
-            in_word = true;
+            results[i] = RunTask(tasks[i], files[tasks[i].file], buffer);
         }
+    };
+
+    const std::size_t thread_count = std::min<std::size_t>(
+        std::max(1U, std::thread::hardware_concurrency()), tasks.size()
+    );
+    if (thread_count <= 1) {
+        worker();
+        return results;
+    }
+
+    std::vector<std::thread> threads;
+    threads.reserve(thread_count - 1);
+    for (std::size_t i = 1; i < thread_count; ++i) {
+        threads.emplace_back(worker);
+    }
+    worker();
+    for (auto &thread : threads) {
+        thread.join();
     }
-    if (in_word) {
-        words++;
+    return results;
+}
+
+// Opens `names` in order and splits them into count tasks, stopping at the
+// first file that can't be opened
+void OpenFiles(
+    const std::vector<std::string> &names,
+    std::vector<InputFile> &files,
+    std::vector<CountTask> &tasks
+) {
+    for (const auto &filename : names) {
+        InputFile file{
+            .fd = ScopedFd(::open(filename.c_str(), O_RDONLY | O_CLOEXEC))};
+        if (!file.fd.IsValid()) {
+            break;
+        }
+
+        struct stat file_stat {};
+        const std::size_t index = files.size();
+        const bool has_stat = ::fstat(file.fd.Get(), &file_stat) == 0;
+        if (has_stat && S_ISDIR(file_stat.st_mode)) {
+            file.directory = true;
+        } else if (!has_stat || !S_ISREG(file_stat.st_mode) ||
+                   file_stat.st_size == 0) {
+            tasks.push_back(CountTask{.file = index, .sequential = true});
+        } else {
+            const auto size = static_cast<std::size_t>(file_stat.st_size);
+            if (size >= MappedFile::kMinSize) {
+                file.mapping = MappedFile::Map(file.fd.Get(), size);
+            }
+            for (std::size_t offset = 0; offset < size;
+                 offset += kSplitChunkSize) {
+                tasks.push_back(CountTask{
+                    .file = index,
+                    .offset = static_cast<off_t>(offset),
+                    .length = std::min(kSplitChunkSize, size - offset)});
+            }
+        }
+        files.push_back(std::move(file));
     }
+}
 
-    return {lines, words, bytes};
+std::string FormatStats(const TextStats &stats) {
+    return std::to_string(stats.lines) + " " + std::to_string(stats.words) +
+           " " + std::to_string(stats.bytes);
 }
 
 }  // namespace
@@ -42,59 +207,129 @@ ExecutionResult WcCommand::Execute(
     std::shared_ptr<IInputChannel> inputChannel,
     std::shared_ptr<IOutputChannel> outputChannel
 ) {
-    std::size_t total_lines = 0;
-    std::size_t total_words = 0;
-    std::size_t total_bytes = 0;
-
     if (args.empty()) {
-        std::string content;
+        // Chunks are counted as they arrive and dropped right away
+        StatsCounter counter;
         while (true) {
             const std::string chunk = inputChannel->Read();
             if (chunk.empty() && inputChannel->IsClosed()) {
                 break;
             }
-            content += chunk;
+            counter.Update(chunk);
         }
 
-        const auto [lines, words, bytes] = CountStats(content);
-        outputChannel->Write(
-            std::to_string(lines) + " " + std::to_string(words) + " " +
-            std::to_string(bytes) + "\n"
-        );
-
+        outputChannel->Write(FormatStats(counter.GetStats()) + "\n");
         return ExecutionResult{};
     }
 
-    for (const auto &filename : args) {
-        std::ifstream file(filename);
-        if (!file.is_open()) {
-            return ExecutionResult{.exit_code = 1};
-        }
+    // Files are opened in order; like before, everything up to the first
+    // file that can't be opened is reported and the rest is skipped
+    std::vector<InputFile> files;
+    std::vector<CountTask> tasks;
+    OpenFiles(args, files, tasks);
+
+    const std::vector<CountResult> results = RunTasks(tasks, files);
 
-        std::stringstream buffer;
-        buffer << file.rdbuf();
-        const std::string content = buffer.str();
-        file.close();
+    // Merge chunk results per file: a word running across a chunk border
+    // was counted at the start of both pieces
+    std::vector<TextStats> file_stats(files.size());
+    std::vector<bool> file_ok(files.size(), true);
+    std::vector<bool> ends_in_word(files.size(), false);
+    for (std::size_t i = 0; i < tasks.size(); ++i) {
+        const std::size_t file = tasks[i].file;
+        TextStats stats = results[i].stats;
+        if (stats.bytes != 0) {
+            if (ends_in_word[file] && results[i].starts_in_word) {
+                stats.words--;
+            }
+            ends_in_word[file] = results[i].ends_in_word;
+        }
+        file_stats[file] += stats;
+        file_ok[file] = file_ok[file] && results[i].ok;
+    }
 
-        auto [lines, words, bytes] = CountStats(content);
-        total_lines += lines;
-        total_words += words;
-        total_bytes += bytes;
+    TextStats total;
+    for (std::size_t i = 0; i < files.size(); ++i) {
+        if (!file_ok[i]) {
+            return ExecutionResult{.exit_code = 1};
+        }
+        total += file_stats[i];
+        outputChannel->Write(FormatStats(file_stats[i]) + " " + args[i] + "\n");
+    }
 
-        outputChannel->Write(
-            std::to_string(lines) + " " + std::to_string(words) + " " +
-            std::to_string(bytes) + " " + filename + "\n"
-        );
+    if (files.size() < args.size()) {
+        return ExecutionResult{.exit_code = 1};
     }
 
     if (args.size() > 1) {
-        outputChannel->Write(
-            std::to_string(total_lines) + " " + std::to_string(total_words) +
-            " " + std::to_string(total_bytes) + " total\n"
-        );
+        outputChannel->Write(FormatStats(total) + " total\n");
     }
 
     return ExecutionResult{};
 }
 
+StageTask WcCommand::ExecuteCooperative(
+    const std::vector<std::string> &args,
+    CooperativeChannel &input,
+    std::shared_ptr<IOutputChannel> output
+) {
+    if (!args.empty()) {
+        co_return Execute(args, input.AsInputChannel(), std::move(output));
+    }
+
+    StatsCounter counter;
+    while (true) {
+        const std::string chunk = co_await input.Read();
+        if (chunk.empty() && input.IsClosed()) {
+            break;
+        }
+        counter.Update(chunk);
+    }
+
+    output->Write(FormatStats(counter.GetStats()) + "\n");
+    co_return ExecutionResult{};
+}
+
+ExecutionResult CatWcCommand::Execute(
+    const std::vector<std::string> &args,
+    std::shared_ptr<IInputChannel> /*inputChannel*/,
+    std::shared_ptr<IOutputChannel> outputChannel
+) {
+    std::vector<InputFile> files;
+    std::vector<CountTask> tasks;
+    OpenFiles(args, files, tasks);
+    const std::vector<CountResult> results = RunTasks(tasks, files);
+
+    // `cat` can't read a directory, it stops there like at a missing file
+    const auto directory = std::ranges::find_if(files, &InputFile::directory);
+    const auto readable =
+        static_cast<std::size_t>(std::distance(files.begin(), directory));
+
+    // One stream across all files: a word running from the end of one file
+    // into the next is a single word. `cat` stops at the first file it
+    // fails to read, so nothing after that is counted
+    TextStats total;
+    bool ends_in_word = false;
+    bool ok = readable == args.size();
+    for (std::size_t i = 0; i < tasks.size() && tasks[i].file < readable;
+         ++i) {
+        const CountResult &result = results[i];
+        TextStats stats = result.stats;
+        if (stats.bytes != 0) {
+            if (ends_in_word && result.starts_in_word) {
+                stats.words--;
+            }
+            ends_in_word = result.ends_in_word;
+        }
+        total += stats;
+        if (!result.ok) {
+            ok = false;
+            break;
+        }
+    }
+
+    outputChannel->Write(FormatStats(total) + "\n");
+    return ExecutionResult{.exit_code = ok ? 0 : 1};
+}
+
 }  // namespace btft::interpreter::executor::commands
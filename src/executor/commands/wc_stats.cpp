@@ -0,0 +1,195 @@
+#include "executor/commands/wc_stats.h"
+#include <bit>
+#include <cstdint>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define BTFT_WC_X86 1
+#include <immintrin.h>
+#else
+#define BTFT_WC_X86 0
+#endif
+
+namespace btft::interpreter::executor::commands {
+
+namespace {
+
+constexpr std::size_t kBlockSize = 64;
+
+#if BTFT_WC_X86
+
+// Folds one 64-byte block given as bit masks (bit i describes byte i)
+void CountBlock(
+    std::uint64_t space_mask,
+    std::uint64_t newline_mask,
+    TextStats &stats,
+    bool &in_word
+) noexcept {
+    // A word starts at a non-space byte whose predecessor is a space; the
+    // predecessor of bit 0 is the last byte of the previous block
+    const std::uint64_t previous_space =
+        (space_mask << 1) | static_cast<std::uint64_t>(!in_word);
+    const std::uint64_t word_starts = ~space_mask & previous_space;
+
+    stats.lines += static_cast<std::size_t>(std::popcount(newline_mask));
+    stats.words += static_cast<std::size_t>(std::popcount(word_starts));
+    in_word = (space_mask >> 63) == 0;
+}
+
+TextStats CountStatsSse2(std::string_view content, bool &in_word) {
+    TextStats stats;
+    const __m128i tab = _mm_set1_epi8('\t');
+    const __m128i range = _mm_set1_epi8('\r' - '\t');
+    const __m128i blank = _mm_set1_epi8(' ');
+    const __m128i newline = _mm_set1_epi8('\n');
+
+    std::size_t i = 0;
+    for (; i + kBlockSize <= content.size(); i += kBlockSize) {
+        std::uint64_t space_mask = 0;
+        std::uint64_t newline_mask = 0;
+        for (std::size_t part = 0; part < kBlockSize / 16; ++part) {
+            const char *data = content.data() + i + part * 16;
+            const __m128i v =
+                _mm_loadu_si128(reinterpret_cast<const __m128i *>(data));
+            // '\t'..'\r' <=> (v - '\t') as unsigned <= '\r' - '\t'
+            const __m128i shifted = _mm_sub_epi8(v, tab);
+            const __m128i in_range =
+                _mm_cmpeq_epi8(_mm_min_epu8(shifted, range), shifted);
+            const __m128i space =
+                _mm_or_si128(in_range, _mm_cmpeq_epi8(v, blank));
+
+            const auto space_bits =
+                static_cast<std::uint16_t>(_mm_movemask_epi8(space));
+            const auto newline_bits = static_cast<std::uint16_t>(
+                _mm_movemask_epi8(_mm_cmpeq_epi8(v, newline))
+            );
+            space_mask |= static_cast<std::uint64_t>(space_bits) << (part * 16);
+            newline_mask |= static_cast<std::uint64_t>(newline_bits)
+                            << (part * 16);
+        }
+        CountBlock(space_mask, newline_mask, stats, in_word);
+    }
+
+    const TextStats tail = CountStatsScalar(content.substr(i), in_word);
+    stats.lines += tail.lines;
+    stats.words += tail.words;
+    stats.bytes = content.size();
+    return stats;
+}
+
+// Sets the bits of `space` and returns the newline mask for 32 bytes
+__attribute__((target("avx2"))) std::uint32_t
+ClassifyAvx2(const char *data, std::uint32_t &space) {
+    const __m256i v =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data));
+    const __m256i shifted = _mm256_sub_epi8(v, _mm256_set1_epi8('\t'));
+    const __m256i in_range = _mm256_cmpeq_epi8(
+        _mm256_min_epu8(shifted, _mm256_set1_epi8('\r' - '\t')), shifted
+    );
+    space = static_cast<std::uint32_t>(_mm256_movemask_epi8(_mm256_or_si256(
+        in_range, _mm256_cmpeq_epi8(v, _mm256_set1_epi8(' '))
+    )));
+    return static_cast<std::uint32_t>(_mm256_movemask_epi8(
+        _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\n'))
+    ));
+}
+
+__attribute__((target("avx2,popcnt"))) TextStats
+CountStatsAvx2(std::string_view content, bool &in_word) {
+    TextStats stats;
+
+    std::size_t i = 0;
+    for (; i + kBlockSize <= content.size(); i += kBlockSize) {
+        std::uint32_t space_lo = 0;
+        std::uint32_t space_hi = 0;
+        const std::uint32_t newline_lo =
+            ClassifyAvx2(content.data() + i, space_lo);
+        const std::uint32_t newline_hi =
+            ClassifyAvx2(content.data() + i + 32, space_hi);
+
+        const std::uint64_t space_mask =
+            space_lo | (static_cast<std::uint64_t>(space_hi) << 32);
+        const std::uint64_t newline_mask =
+            newline_lo | (static_cast<std::uint64_t>(newline_hi) << 32);
+
+        // Same as CountBlock, spelled out so that popcnt is used here
+        const std::uint64_t previous_space =
+            (space_mask << 1) | static_cast<std::uint64_t>(!in_word);
+        stats.lines +=
+            static_cast<std::size_t>(__builtin_popcountll(newline_mask));
+        stats.words += static_cast<std::size_t>(
+            __builtin_popcountll(~space_mask & previous_space)
+        );
+        in_word = (space_mask >> 63) == 0;
+    }
+
+    const TextStats tail = CountStatsScalar(content.substr(i), in_word);
+    stats.lines += tail.lines;
+    stats.words += tail.words;
+    stats.bytes = content.size();
+    return stats;
+}
+
+#endif
+
+using CountFunction = TextStats (*)(std::string_view, bool &);
+
+CountFunction SelectImplementation() {
+#if BTFT_WC_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("popcnt")) {
+        return CountStatsAvx2;
+    }
+    return CountStatsSse2;
+#else
+    return CountStatsScalar;
+#endif
+}
+
+}  // namespace
+
+TextStats CountStatsScalar(std::string_view content, bool &in_word) {
+    TextStats stats;
+    stats.bytes = content.size();
+
+    for (const char c : content) {
+        const auto byte = static_cast<unsigned char>(c);
+        if (byte == '\n') {
+            stats.lines++;
+        }
+        if (IsWhitespace(byte)) {
+            in_word = false;
+        } else {
+            if (!in_word) {
+                stats.words++;
+            }
+            in_word = true;
+        }
+    }
+
+    return stats;
+}
+
+std::vector<CountKernel> AvailableCountKernels() {
+    std::vector<CountKernel> kernels = {{"scalar", CountStatsScalar}};
+#if BTFT_WC_X86
+    // SSE2 is part of x86-64
+    kernels.push_back({"sse2", CountStatsSse2});
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("popcnt")) {
+        kernels.push_back({"avx2", CountStatsAvx2});
+    }
+#endif
+    return kernels;
+}
+
+TextStats CountStats(std::string_view content, bool &in_word) {
+    static const CountFunction implementation = SelectImplementation();
+    return implementation(content, in_word);
+}
+
+TextStats CountStats(std::string_view content) {
+    bool in_word = false;
+    return CountStats(content, in_word);
+}
+
+}  // namespace btft::interpreter::executor::commands
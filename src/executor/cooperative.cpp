@@ -0,0 +1,104 @@
+#include "executor/cooperative.h"
+
+namespace btft::interpreter::executor {
+
+StageTask &StageTask::operator=(StageTask &&other) noexcept {
+    if (this != &other) {
+        if (handle) {
+            handle.destroy();
+        }
+        handle = std::exchange(other.handle, nullptr);
+    }
+    return *this;
+}
+
+StageTask::~StageTask() {
+    if (handle) {
+        handle.destroy();
+    }
+}
+
+ExecutionResult StageTask::TakeResult() {
+    promise_type &promise = handle.promise();
+    if (promise.exception) {
+        std::rethrow_exception(std::exchange(promise.exception, nullptr));
+    }
+    return std::move(promise.result);
+}
+
+bool CooperativeChannel::ReadAwaiter::await_ready() const noexcept {
+    return channel.source || !channel.chunks.empty() || channel.writer_closed;
+}
+
+void CooperativeChannel::ReadAwaiter::await_suspend(
+    std::coroutine_handle<> /*reader*/
+) noexcept {
+    // The executor resumes the stage through `resume_reader`, which also
+    // notices when the stage finishes
+    channel.reader_waiting = true;
+}
+
+std::string CooperativeChannel::ReadAwaiter::await_resume() {
+    if (channel.source) {
+        return channel.source->Read();
+    }
+    if (channel.chunks.empty()) {
+        return {};
+    }
+    std::string chunk = std::move(channel.chunks.front());
+    channel.chunks.pop_front();
+    return chunk;
+}
+
+bool CooperativeChannel::IsClosed() const {
+    if (source) {
+        return source->IsClosed();
+    }
+    return writer_closed && chunks.empty();
+}
+
+void CooperativeChannel::CloseReader() {
+    reader_closed = true;
+    chunks.clear();
+}
+
+std::shared_ptr<IInputChannel> CooperativeChannel::AsInputChannel() const {
+    if (source) {
+        return source;
+    }
+    static const std::shared_ptr<IInputChannel> kEmpty = []() {
+        auto channel = std::make_shared<Channel>(1);
+        channel->CloseChannel();
+        return channel;
+    }();
+    return kEmpty;
+}
+
+void CooperativeChannel::Write(const std::string &buffer) {
+    Write(std::string(buffer));
+}
+
+void CooperativeChannel::Write(std::string &&buffer) {
+    if (reader_closed) {
+        throw ChannelClosedError("Reader of the pipe has finished");
+    }
+    if (buffer.empty()) {
+        return;
+    }
+    chunks.push_back(std::move(buffer));
+    WakeReader();
+}
+
+void CooperativeChannel::CloseChannel() {
+    writer_closed = true;
+    WakeReader();
+}
+
+void CooperativeChannel::WakeReader() {
+    if (reader_waiting) {
+        reader_waiting = false;
+        resume_reader();
+    }
+}
+
+}  // namespace btft::interpreter::executor
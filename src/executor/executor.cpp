@@ -1,11 +1,22 @@
 #include "executor/executor.h"
 #include <environment.h>
+#include <algorithm>
 #include <atomic>
+#include <functional>
 #include <iostream>
+#include <iterator>
 #include <memory>
-#include <thread>
+#include <optional>
+#include <tuple>
+#include <utility>
 #include "executor/channel.h"
+#include "executor/commands/external.h"
 #include "executor/commands/registry.h"
+#include "executor/commands/wc.h"
+#include "executor/cooperative.h"
+#include "executor/fd_channel.h"
+#include "executor/spsc_channel.h"
+#include "executor/stage_pool.h"
 
 namespace btft::interpreter::executor {
 
@@ -17,145 +28,368 @@ struct PipelineState {
     std::atomic<bool> should_exit{false};
 };
 
-std::string ExpandVars(std::string_view s) {
-    std::string out;
-    out.reserve(s.size());
+struct ExpandedCommand {
+    std::string name;
+    std::vector<std::string> args;
+};
 
-    for (std::size_t i = 0; i < s.size(); ++i) {
-        if (const char c = s[i]; c != '$') {
-            out.push_back(c);
-            continue;
-        }
+ExpandedCommand ExpandCommandNode(
+    const CommandNode &node,
+    const EnvironmentSnapshot &env
+) {
+    ExpandedCommand out;
 
-        if (i + 1 >= s.size() || !IsVarStart(s[i + 1])) {
-            out.push_back('$');
-            continue;
-        }
+    out.name = node.GetNameTemplate().Expand(env);
+    out.args.reserve(node.GetArgTemplates().size());
+    for (const auto &arg : node.GetArgTemplates()) {
+        out.args.push_back(arg.Expand(env));
+    }
 
-        std::size_t j = i + 1;
-        while (j < s.size() && IsVarChar(s[j])) {
-            ++j;
-        }
+    return out;
+}
 
-        const std::string name(s.substr(i + 1, j - (i + 1)));
-        if (const auto val = Environment::GetInstance().GetVar(name);
-            val.has_value()) {
-            out += *val;
-        }
+// A command resolved before the pipeline starts: the executor has to know
+// which stages are external to decide how to connect them. `command` is
+// the registered builtin and unset for external stages, which all go to
+// the one ExternalCommand with `env`
+struct Stage {
+    commands::ICommand *command = nullptr;
+    std::vector<std::string> args;
+    bool is_external = false;
+    const EnvironmentSnapshot *env = nullptr;
+};
 
-        i = j - 1;
+Stage PrepareStage(const CommandNode &node, const EnvironmentSnapshot &env) {
+    ExpandedCommand expanded = ExpandCommandNode(node, env);
+
+    Stage stage;
+    stage.command = CommandsRegistry::GetInstance().FindCommand(expanded.name);
+    stage.is_external = stage.command == nullptr;
+    if (stage.is_external) {
+        stage.env = &env;
+        stage.args.reserve(expanded.args.size() + 1);
+        stage.args.push_back(std::move(expanded.name));
+        std::move(
+            expanded.args.begin(), expanded.args.end(),
+            std::back_inserter(stage.args)
+        );
+    } else {
+        stage.args = std::move(expanded.args);
     }
+    return stage;
+}
 
-    return out;
+ExecutionResult RunStage(
+    const Stage &stage,
+    std::shared_ptr<IInputChannel> input_channel,
+    std::shared_ptr<IOutputChannel> output_channel
+) {
+    if (stage.is_external) {
+        return commands::ExternalCommand::GetInstance().Execute(
+            *stage.env, stage.args, std::move(input_channel),
+            std::move(output_channel)
+        );
+    }
+    return stage.command->Execute(
+        stage.args, std::move(input_channel), std::move(output_channel)
+    );
 }
 
-[[nodiscard]] std::string ExpandArgToken(const interpreter::ArgToken &tok) {
-    std::string out;
+// Whether `stage` is the builtin registered as `name`
+bool IsBuiltin(const Stage &stage, std::string_view name) {
+    return !stage.is_external &&
+           stage.command == CommandsRegistry::GetInstance().FindCommand(name);
+}
 
-    for (const auto &seg : tok.segments) {
-        if (!seg.allow_expansion) {
-            out += seg.text;
+// Rewrites the stages of a line into fewer ones with the same output and
+// exit code:
+// - `cat` without arguments only copies its input to its output, so it is
+//   dropped (unless nothing else is left). At either end of the line it
+//   stays in front of an external command: the program would otherwise get
+//   the shell's own stdin or stdout and could tell (isatty, lseek)
+// - `cat FILE... | wc` becomes one CatWcCommand that counts the files
+//   without passing them through a channel
+void FuseStages(std::vector<Stage> &stages) {
+    for (std::size_t i = 0; i < stages.size() && stages.size() > 1;) {
+        const bool keeps_stdin_from_external =
+            i == 0 && stages[i + 1].is_external;
+        const bool keeps_stdout_from_external =
+            i + 1 == stages.size() && stages[i - 1].is_external;
+        if (IsBuiltin(stages[i], "cat") && stages[i].args.empty() &&
+            !keeps_stdin_from_external && !keeps_stdout_from_external) {
+            stages.erase(stages.begin() + static_cast<std::ptrdiff_t>(i));
         } else {
-            out += ExpandVars(seg.text);
+            ++i;
         }
     }
 
-    return out;
+    static commands::CatWcCommand cat_wc;
+    for (std::size_t i = 0; i + 1 < stages.size(); ++i) {
+        if (IsBuiltin(stages[i], "cat") && !stages[i].args.empty() &&
+            IsBuiltin(stages[i + 1], "wc") && stages[i + 1].args.empty()) {
+            stages[i].command = &cat_wc;
+            stages.erase(stages.begin() + static_cast<std::ptrdiff_t>(i + 1));
+        }
+    }
 }
 
-struct ExpandedCommand {
-    std::string name;
-    std::vector<std::string> args;
-};
-
-ExpandedCommand ExpandCommandNode(const CommandNode &node) {
-    ExpandedCommand out;
-
-    out.name = ExpandArgToken(node.GetName());
-    for (const auto &a : node.GetArgs()) {
-        out.args.push_back(ExpandArgToken(a));
+// Update pipeline state if command failed or requested exit
+void RecordResult(PipelineState &state, const ExecutionResult &result) {
+    if (result.exit_code != 0 || result.should_exit) {
+        bool expected = false;
+        if (state.should_stop.compare_exchange_strong(expected, true)) {
+            // First stage to set error state
+            state.exit_code.store(result.exit_code);
+            state.should_exit.store(result.should_exit);
+        }
     }
-
-    return out;
 }
 
 void SingleNodeExecution(
     const std::shared_ptr<IInputChannel> &input_channel,
     const std::shared_ptr<IOutputChannel> &output_channel,
-    const CommandNode &node,
+    const Stage &stage,
     const std::shared_ptr<PipelineState> &state
 ) {
     // Check if pipeline should stop before executing
     if (state->should_stop.load()) {
+        input_channel->CloseChannel();
         output_channel->CloseChannel();
         return;
     }
 
-    const ExpandedCommand expanded = ExpandCommandNode(node);
-
     ExecutionResult result{};
-    const auto command =
-        CommandsRegistry::GetInstance().GetCommand(expanded.name);
-    if (dynamic_cast<commands::ExternalCommand *>(command.get()) == nullptr) {
-        result = command->Execute(expanded.args, input_channel, output_channel);
-    } else {
-        std::vector<std::string> argv;
-        argv.reserve(expanded.args.size() + 1);
-        argv.push_back(expanded.name);
-        argv.insert(argv.end(), expanded.args.begin(), expanded.args.end());
-        result = command->Execute(argv, input_channel, output_channel);
+    try {
+        result = RunStage(stage, input_channel, output_channel);
+    } catch (const ChannelClosedError &) {
+        // The next stage stopped reading, nobody needs the rest of our output
     }
 
+    // Release a producer that may still be blocked on our bounded input
+    input_channel->CloseChannel();
     output_channel->CloseChannel();
 
-    // Update pipeline state if command failed or requested exit
-    if (result.exit_code != 0 || result.should_exit) {
-        bool expected = false;
-        if (state->should_stop.compare_exchange_strong(expected, true)) {
-            // First thread to set error state
-            state->exit_code.store(result.exit_code);
-            state->should_exit.store(result.should_exit);
+    RecordResult(*state, result);
+}
+
+// The terminal ends of every line; they hold no state, so one pair serves
+// all commands
+const std::shared_ptr<InputStdChannel> &StdInputChannel() {
+    static const std::shared_ptr<InputStdChannel> channel =
+        std::make_shared<InputStdChannel>();
+    return channel;
+}
+
+const std::shared_ptr<IInputChannel> &StdInput() {
+    static const std::shared_ptr<IInputChannel> channel = StdInputChannel();
+    return channel;
+}
+
+const std::shared_ptr<IOutputChannel> &StdOutput() {
+    static const std::shared_ptr<IOutputChannel> channel =
+        std::make_shared<OutputStdChannel>();
+    return channel;
+}
+
+// A builtin of a pipeline that runs on the calling thread, see
+// RunCooperative. `input` belongs to this stage, `output` is the input of
+// the next one (null for the last stage, which writes to stdout).
+struct CooperativeStage {
+    std::optional<StageTask> task;
+    std::shared_ptr<CooperativeChannel> input;
+    std::shared_ptr<CooperativeChannel> output;
+};
+
+void FinishStage(
+    CooperativeStage &stage,
+    PipelineState &state,
+    const ExecutionResult &result
+) {
+    RecordResult(state, result);
+    stage.input->CloseReader();
+    if (stage.output) {
+        // May run the next stage to completion right here
+        stage.output->CloseChannel();
+    }
+}
+
+// Runs the stage until it waits for input again or finishes
+void ResumeStage(CooperativeStage &stage, PipelineState &state) {
+    stage.task->Resume();
+    if (!stage.task->Done()) {
+        return;
+    }
+
+    ExecutionResult result{};
+    try {
+        result = stage.task->TakeResult();
+    } catch (const ChannelClosedError &) {
+        // The next stage stopped reading, nobody needs the rest of our output
+    }
+    FinishStage(stage, state, result);
+}
+
+// Builtin-only pipelines need no threads: every stage is a coroutine that
+// suspends while its input is empty, and a write resumes the reader on the
+// spot. Stages are started from the last one, so each writer finds its
+// reader already waiting; the first stage then drives the whole pipeline.
+void RunCooperative(const std::vector<Stage> &stages, PipelineState &state) {
+    std::vector<CooperativeStage> pipeline(stages.size());
+    pipeline.front().input = std::make_shared<CooperativeChannel>(StdInput());
+    for (std::size_t i = 1; i < stages.size(); ++i) {
+        pipeline[i].input = std::make_shared<CooperativeChannel>(
+            [&pipeline, &state, i]() { ResumeStage(pipeline[i], state); }
+        );
+        pipeline[i - 1].output = pipeline[i].input;
+    }
+
+    for (std::size_t i = 0; i < stages.size(); ++i) {
+        const std::shared_ptr<IOutputChannel> output =
+            pipeline[i].output ? pipeline[i].output : StdOutput();
+        pipeline[i].task = stages[i].command->ExecuteCooperative(
+            stages[i].args, *pipeline[i].input, output
+        );
+    }
+
+    for (std::size_t i = stages.size(); i-- > 0;) {
+        if (state.should_stop.load()) {
+            FinishStage(pipeline[i], state, ExecutionResult{});
+        } else {
+            ResumeStage(pipeline[i], state);
         }
     }
 }
 
+// A child process reading stdin continues where the shell's lines end
+void PrepareStdinFor(const Stage &first_stage) {
+    if (first_stage.is_external) {
+        StdInputChannel()->ReturnUnread();
+    }
+}
+
+// A stage that makes up the whole line, run on the calling thread straight
+// against stdin and stdout
+ExecutionResult RunAlone(const Stage &stage) {
+    PrepareStdinFor(stage);
+    ExecutionResult result{};
+    try {
+        result = RunStage(stage, StdInput(), StdOutput());
+    } catch (const ChannelClosedError &) {
+        // stdout went away, same quiet end as inside a pipeline
+    }
+    return result;
+}
+
 }  // namespace
 
+bool ReadInputLine(std::string &line) {
+    return StdInputChannel()->ReadLine(line);
+}
+
+void FlushOutput() {
+    try {
+        StdOutput()->Flush();
+    } catch (const ChannelClosedError &) {
+        // stdout went away, there is nobody to tell
+    }
+}
+
+void ApplyAssignments(const PipelineNode &pipeline) {
+    auto &env = Environment::GetInstance();
+    const bool make_global = pipeline.Empty();
+    for (const auto &assignment : pipeline.GetAssignments()) {
+        // Expanded one by one against the live variables, so `a=1 b=$a`
+        // sees the new a without building a snapshot per assignment
+        const std::string value = assignment.GetValueTemplate().Expand(
+            [&env](const std::string &name) { return env.GetVar(name); }
+        );
+        if (make_global) {
+            env.SetGlobal(assignment.GetName(), value);
+        } else {
+            env.SetLocal(assignment.GetName(), value);
+        }
+    }
+}
+
+ExecutionResult ExecuteCommand(const CommandNode &node) {
+    const std::shared_ptr<const EnvironmentSnapshot> env =
+        Environment::GetInstance().GetSnapshot();
+    const Stage stage = PrepareStage(node, *env);
+
+    return RunAlone(stage);
+}
+
 ExecutionResult ExecutePipeline(const std::vector<CommandNode> &nodes) {
-    std::vector<std::thread> pipeline;
+    if (nodes.size() == 1) {
+        return ExecuteCommand(nodes.front());
+    }
+
     auto state = std::make_shared<PipelineState>();
 
+    // Every stage sees the variables as they were when the line started,
+    // and reads them without locking
+    const std::shared_ptr<const EnvironmentSnapshot> env =
+        Environment::GetInstance().GetSnapshot();
+
+    std::vector<Stage> stages;
+    stages.reserve(nodes.size());
+    for (const auto &node : nodes) {
+        stages.push_back(PrepareStage(node, *env));
+    }
+
+    FuseStages(stages);
+    if (stages.size() == 1) {
+        return RunAlone(stages.front());
+    }
+
+    if (std::ranges::none_of(stages, &Stage::is_external)) {
+        RunCooperative(stages, *state);
+        return ExecutionResult{
+            .exit_code = state->exit_code.load(),
+            .should_exit = state->should_exit.load()};
+    }
+
     std::vector<std::shared_ptr<IInputChannel>> input_channels(
-        nodes.size(), nullptr
+        stages.size(), nullptr
     );
     std::vector<std::shared_ptr<IOutputChannel>> output_channels(
-        nodes.size(), nullptr
+        stages.size(), nullptr
     );
 
-    for (std::size_t i = 0; i + 1 < nodes.size(); ++i) {
-        auto common_channel = std::make_shared<Channel>();
+    for (std::size_t i = 0; i + 1 < stages.size(); ++i) {
+        // An external process reads or writes a kernel pipe directly, so two
+        // adjacent external commands talk without a shell thread in between
+        if (stages[i].is_external || stages[i + 1].is_external) {
+            std::tie(input_channels[i + 1], output_channels[i]) = MakePipe();
+            continue;
+        }
+
+        // Each channel has exactly one writer and one reader thread
+        auto common_channel = std::make_shared<SpscChannel>();
         // splits assignment into 2 lines
         // clang-format off
-        input_channels[i + 1] = dynamic_pointer_cast<IInputChannel, Channel>(common_channel);
-        output_channels[i] = dynamic_pointer_cast<IOutputChannel, Channel>(common_channel);
+        input_channels[i + 1] = dynamic_pointer_cast<IInputChannel, SpscChannel>(common_channel);
+        output_channels[i] = dynamic_pointer_cast<IOutputChannel, SpscChannel>(common_channel);
         // clang-format on
     }
 
     // create channels for std::cout and std::cin
-    input_channels.front() = std::make_shared<InputStdChannel>();
-    output_channels.back() = std::make_shared<OutputStdChannel>();
-
-    for (std::size_t i = 0; i < nodes.size(); ++i) {
-        pipeline.emplace_back(
-            SingleNodeExecution, input_channels[i], output_channels[i],
-            std::cref(nodes[i]), state
-
-        );
-    }
-
-    for (auto &thread : pipeline) {
-        thread.join();
+    PrepareStdinFor(stages.front());
+    input_channels.front() = StdInput();
+    output_channels.back() = StdOutput();
+
+    // Stages run on reusable pool workers instead of a fresh thread each
+    std::vector<std::function<void()>> pipeline;
+    pipeline.reserve(stages.size());
+    for (std::size_t i = 0; i < stages.size(); ++i) {
+        pipeline.emplace_back([&input_channels, &output_channels, &stages,
+                               &state, i]() {
+            SingleNodeExecution(
+                input_channels[i], output_channels[i], stages[i], state
+            );
+        });
     }
+    StagePool::GetInstance().RunAll(pipeline);
 
     ExecutionResult result;
     result.exit_code = state->exit_code.load();
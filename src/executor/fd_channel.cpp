@@ -0,0 +1,121 @@
+#include "executor/fd_channel.h"
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+#include <system_error>
+
+namespace btft::interpreter::executor {
+
+namespace {
+
+void CloseFd(int &fd) noexcept {
+    if (fd >= 0) {
+        ::close(fd);
+        fd = -1;
+    }
+}
+
+}  // namespace
+
+FdInputChannel::~FdInputChannel() {
+    CloseFd(fd);
+}
+
+std::string FdInputChannel::Read() {
+    if (fd < 0 || eof) {
+        return {};
+    }
+
+    std::string result(kReadChunkSize, '\0');
+    ssize_t count = 0;
+    do {
+        count = ::read(fd, result.data(), result.size());
+    } while (count < 0 && errno == EINTR);
+
+    if (count <= 0) {
+        eof = true;
+        return {};
+    }
+    result.resize(static_cast<std::size_t>(count));
+    return result;
+}
+
+void FdInputChannel::CloseChannel() {
+    CloseFd(fd);
+}
+
+bool FdInputChannel::IsClosed() const {
+    return fd < 0 || eof;
+}
+
+std::optional<int> FdInputChannel::GetFd() const {
+    if (fd < 0) {
+        return std::nullopt;
+    }
+    return fd;
+}
+
+FdOutputChannel::~FdOutputChannel() {
+    CloseFd(fd);
+}
+
+void FdOutputChannel::Write(const std::string &buffer) {
+    if (fd < 0) {
+        throw ChannelClosedError("Channel is closed, you can't write into it");
+    }
+
+    std::size_t written = 0;
+    while (written < buffer.size()) {
+        const ssize_t count =
+            ::write(fd, buffer.data() + written, buffer.size() - written);
+        if (count < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw ChannelClosedError(std::strerror(errno));
+        }
+        written += static_cast<std::size_t>(count);
+    }
+}
+
+void FdOutputChannel::CloseChannel() {
+    CloseFd(fd);
+}
+
+std::optional<int> FdOutputChannel::GetFd() const {
+    if (fd < 0) {
+        return std::nullopt;
+    }
+    return fd;
+}
+
+std::pair<std::shared_ptr<FdInputChannel>, std::shared_ptr<FdOutputChannel>>
+MakePipe() {
+    int fds[2] = {-1, -1};
+#if defined(__linux__)
+    // Close-on-exec from the start: stages create pipes while others are
+    // spawning children
+    if (::pipe2(fds, O_CLOEXEC) != 0) {
+        throw std::system_error(errno, std::generic_category(), "pipe2");
+    }
+#else
+    // pipe2 is not available on macOS
+    if (::pipe(fds) != 0) {
+        throw std::system_error(errno, std::generic_category(), "pipe");
+    }
+    if (::fcntl(fds[0], F_SETFD, FD_CLOEXEC) != 0 ||
+        ::fcntl(fds[1], F_SETFD, FD_CLOEXEC) != 0) {
+        const int error = errno;
+        CloseFd(fds[0]);
+        CloseFd(fds[1]);
+        throw std::system_error(error, std::generic_category(), "fcntl");
+    }
+#endif
+
+    return {
+        std::make_shared<FdInputChannel>(fds[0]),
+        std::make_shared<FdOutputChannel>(fds[1])};
+}
+
+}  // namespace btft::interpreter::executor
@@ -0,0 +1,93 @@
+#include "executor/mapped_file.h"
+#include <sys/mman.h>
+#include <csetjmp>
+#include <csignal>
+#include <mutex>
+#include <utility>
+
+namespace btft::interpreter::executor {
+
+namespace {
+
+// Where the SIGBUS handler returns to on this thread, null outside Guarded
+thread_local sigjmp_buf *guard_target = nullptr;
+
+struct sigaction previous_sigbus_action {};
+
+void HandleSigbus(int signal, siginfo_t * /*info*/, void * /*context*/) {
+    if (guard_target != nullptr) {
+        siglongjmp(*guard_target, 1);
+    }
+    // Not a guarded read: whatever handled SIGBUS before gets it
+    ::sigaction(SIGBUS, &previous_sigbus_action, nullptr);
+    ::raise(signal);
+}
+
+void InstallSigbusHandler() {
+    struct sigaction action {};
+    action.sa_sigaction = HandleSigbus;
+    action.sa_flags = SA_SIGINFO;
+    sigemptyset(&action.sa_mask);
+    ::sigaction(SIGBUS, &action, &previous_sigbus_action);
+}
+
+}  // namespace
+
+bool MappedFile::RunGuarded(void (*body)(void *), void *context) {
+    static std::once_flag installed;
+    std::call_once(installed, InstallSigbusHandler);
+
+    sigjmp_buf target;
+    // Restores the signal mask too, SIGBUS is blocked inside the handler
+    if (sigsetjmp(target, 1) != 0) {
+        guard_target = nullptr;
+        return false;
+    }
+    guard_target = &target;
+    body(context);
+    guard_target = nullptr;
+    return true;
+}
+
+std::optional<MappedFile> MappedFile::Map(int fd, std::size_t size) {
+    if (size == 0) {
+        return std::nullopt;
+    }
+
+    void *data = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (data == MAP_FAILED) {
+        return std::nullopt;
+    }
+    // Only a hint, the mapping works the same if it is ignored
+    ::madvise(data, size, MADV_SEQUENTIAL);
+
+    return MappedFile(data, size);
+}
+
+MappedFile::~MappedFile() {
+    Unmap();
+}
+
+MappedFile::MappedFile(MappedFile &&other) noexcept
+    : data(std::exchange(other.data, nullptr)),
+      size(std::exchange(other.size, 0)) {
+}
+
+MappedFile &MappedFile::operator=(MappedFile &&other) noexcept {
+    if (this != &other) {
+        Unmap();
+        data = std::exchange(other.data, nullptr);
+        size = std::exchange(other.size, 0);
+    }
+    return *this;
+}
+
+void MappedFile::Unmap() noexcept {
+    if (data != nullptr) {
+        ::munmap(data, size);
+        data = nullptr;
+        size = 0;
+    }
+}
+
+}  // namespace btft::interpreter::executor
@@ -0,0 +1,147 @@
+#include "executor/spsc_channel.h"
+#include <algorithm>
+#include <utility>
+
+namespace btft::interpreter::executor {
+
+namespace {
+
+constexpr int kSpinIterations = 128;
+
+void CpuRelax() noexcept {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__)
+    asm volatile("yield");
+#endif
+}
+
+// Waits until `ready()` holds: spins first, then sleeps on `epoch`. The
+// sequentially consistent `parked` store followed by the `epoch` load pairs
+// with Wake below, so a wakeup can not slip in between the last check and
+// the wait.
+template <typename Predicate>
+void SpinThenPark(
+    const Predicate &ready,
+    std::atomic<std::uint32_t> &epoch,
+    std::atomic<bool> &parked
+) {
+    for (int i = 0; i < kSpinIterations; ++i) {
+        if (ready()) {
+            return;
+        }
+        CpuRelax();
+    }
+
+    while (!ready()) {
+        parked.store(true);
+        const std::uint32_t seen = epoch.load();
+        if (!ready()) {
+            epoch.wait(seen);
+        }
+        parked.store(false);
+    }
+}
+
+void Wake(std::atomic<std::uint32_t> &epoch, std::atomic<bool> &parked) {
+    epoch.fetch_add(1);
+    // Only the first waker after a park pays for the syscall
+    if (parked.exchange(false)) {
+        epoch.notify_one();
+    }
+}
+
+}  // namespace
+
+SpscChannel::SpscChannel(std::size_t capacity)
+    : slots(kSlots), capacity(std::max<std::size_t>(capacity, 1)) {
+}
+
+bool SpscChannel::HasRoom(std::size_t tail_index, std::size_t bytes)
+    const noexcept {
+    if (tail_index - head.load(std::memory_order_acquire) >= slots.size()) {
+        return false;
+    }
+    const std::size_t in_flight =
+        bytes_written.load(std::memory_order_relaxed) -
+        bytes_read.load(std::memory_order_acquire);
+    return in_flight == 0 || in_flight + bytes <= capacity;
+}
+
+void SpscChannel::Write(const std::string &buffer) {
+    Write(std::string(buffer));
+}
+
+void SpscChannel::Write(std::string &&buffer) {
+    if (buffer.empty()) {
+        return;
+    }
+
+    const std::size_t t = tail.load(std::memory_order_relaxed);
+    SpinThenPark(
+        [this, t, &buffer]() {
+            return closed.load(std::memory_order_acquire) ||
+                   HasRoom(t, buffer.size());
+        },
+        writable_epoch, writer_parked
+    );
+    if (closed.load(std::memory_order_acquire)) {
+        throw ChannelClosedError("Channel is closed, you can't write into it");
+    }
+
+    const std::size_t size = buffer.size();
+    slots[t % slots.size()] = std::move(buffer);
+    bytes_written.store(
+        bytes_written.load(std::memory_order_relaxed) + size,
+        std::memory_order_relaxed
+    );
+    tail.store(t + 1, std::memory_order_release);
+    Wake(readable_epoch, reader_parked);
+}
+
+std::string SpscChannel::Read() {
+    const std::size_t h = head.load(std::memory_order_relaxed);
+    SpinThenPark(
+        [this, h]() {
+            return tail.load(std::memory_order_acquire) != h ||
+                   closed.load(std::memory_order_acquire);
+        },
+        readable_epoch, reader_parked
+    );
+    // The writer publishes its last chunk before closing, so an empty ring
+    // seen after `closed` means end of stream
+    if (tail.load(std::memory_order_acquire) == h) {
+        return {};
+    }
+
+    std::string &slot = slots[h % slots.size()];
+    std::string result = std::move(slot);
+    slot = std::string{};
+
+    const std::size_t consumed =
+        bytes_read.load(std::memory_order_relaxed) + result.size();
+    bytes_read.store(consumed, std::memory_order_release);
+    head.store(h + 1, std::memory_order_release);
+
+    // A blocked writer is only woken once the ring is half drained, so that
+    // it refills it in one go instead of ping-ponging on every slot
+    const std::size_t t = tail.load(std::memory_order_acquire);
+    if (t - (h + 1) <= slots.size() / 2 ||
+        bytes_written.load(std::memory_order_relaxed) - consumed <=
+            capacity / 2) {
+        Wake(writable_epoch, writer_parked);
+    }
+    return result;
+}
+
+void SpscChannel::CloseChannel() {
+    closed.store(true, std::memory_order_release);
+    Wake(readable_epoch, reader_parked);
+    Wake(writable_epoch, writer_parked);
+}
+
+bool SpscChannel::IsClosed() const {
+    return closed.load(std::memory_order_acquire);
+}
+
+}  // namespace btft::interpreter::executor
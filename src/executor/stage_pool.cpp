@@ -0,0 +1,76 @@
+#include "executor/stage_pool.h"
+
+namespace btft::interpreter::executor {
+
+namespace {
+
+// A job escaping with an exception would leave the other stages running
+// on our stack frame; terminate just like a plain std::thread would
+void RunInline(const std::function<void()> &job) noexcept {
+    job();
+}
+
+}  // namespace
+
+void StagePool::RunAll(const std::vector<std::function<void()>> &jobs) {
+    if (jobs.empty()) {
+        return;
+    }
+
+    std::latch done(static_cast<std::ptrdiff_t>(jobs.size() - 1));
+    {
+        const std::lock_guard lock(mutex);
+        for (std::size_t i = 0; i + 1 < jobs.size(); ++i) {
+            queue.push_back(QueuedJob{.job = &jobs[i], .done = &done});
+        }
+        while (idle_workers < queue.size()) {
+            workers.emplace_back(&StagePool::WorkerLoop, this);
+            ++idle_workers;
+        }
+    }
+    job_ready.notify_all();
+
+    RunInline(jobs.back());
+    done.wait();
+}
+
+std::size_t StagePool::GetWorkerCount() const {
+    const std::lock_guard lock(mutex);
+    return workers.size();
+}
+
+StagePool::~StagePool() {
+    {
+        const std::lock_guard lock(mutex);
+        stopping = true;
+    }
+    job_ready.notify_all();
+    for (auto &worker : workers) {
+        worker.join();
+    }
+}
+
+void StagePool::WorkerLoop() {
+    std::unique_lock lock(mutex);
+    while (true) {
+        job_ready.wait(lock, [this]() { return stopping || !queue.empty(); });
+        if (queue.empty()) {
+            return;
+        }
+
+        const QueuedJob job = queue.front();
+        queue.pop_front();
+        --idle_workers;
+
+        lock.unlock();
+        (*job.job)();
+        lock.lock();
+
+        // Back to idle before the caller can see the job finished, so the
+        // next RunAll counts this worker as available
+        ++idle_workers;
+        job.done->count_down();
+    }
+}
+
+}  // namespace btft::interpreter::executor
@@ -0,0 +1,43 @@
+#include "expansion.h"
+#include <string_view>
+#include <utility>
+#include "common.h"
+#include "environment.h"
+
+namespace btft::interpreter {
+
+ExpansionTemplate ExpansionTemplate::Compile(const ArgToken &token) {
+    ExpansionTemplate compiled;
+
+    for (const auto &segment : token.segments) {
+        const std::string_view s = segment.text;
+        if (!segment.allow_expansion) {
+            compiled.literal += s;
+            continue;
+        }
+
+        for (std::size_t i = 0; i < s.size(); ++i) {
+            if (s[i] != '$' || i + 1 >= s.size() || !IsVarStart(s[i + 1])) {
+                compiled.literal.push_back(s[i]);
+                continue;
+            }
+
+            std::size_t j = i + 1;
+            while (j < s.size() && IsVarChar(s[j])) {
+                ++j;
+            }
+            compiled.slots.push_back(Slot{
+                .offset = compiled.literal.size(),
+                .name = std::string(s.substr(i + 1, j - (i + 1)))});
+            i = j - 1;
+        }
+    }
+
+    return compiled;
+}
+
+std::string ExpansionTemplate::Expand(const EnvironmentSnapshot &env) const {
+    return Expand([&env](const std::string &name) { return env.Find(name); });
+}
+
+}  // namespace btft::interpreter
@@ -1,15 +1,27 @@
+#include <csignal>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <string_view>
 #include "executor/commands/cat.h"
 #include "executor/commands/echo.h"
 #include "executor/commands/exit.h"
+#include "executor/commands/hash.h"
 #include "executor/commands/pwd.h"
 #include "executor/commands/registry.h"
+#include "executor/commands/stats.h"
 #include "executor/commands/wc.h"
+#include "parser/parse_cache.h"
 #include "shell_repl.h"
 
-int main() {
+int main(int argc, char *argv[]) {
     // NOLINTNEXTLINE
     using namespace btft::interpreter::executor;
 
+    // Pipeline stages notice a vanished reader through EPIPE, the process
+    // itself must survive it
+    std::signal(SIGPIPE, SIG_IGN);
+
     // Register all built-in commands
     auto &registry = CommandsRegistry::GetInstance();
     registry.RegisterCommand<commands::EchoCommand>("echo");
@@ -17,7 +29,34 @@ int main() {
     registry.RegisterCommand<commands::PwdCommand>("pwd");
     registry.RegisterCommand<commands::WcCommand>("wc");
     registry.RegisterCommand<commands::ExitCommand>("exit");
+    registry.RegisterCommand<commands::HashCommand>("hash");
+    registry.RegisterCommand<commands::StatsCommand>("stats");
+
+    // BTFT_PARSE_CACHE_SIZE=0 turns the parse cache off
+    // NOLINTNEXTLINE(concurrency-mt-unsafe)
+    if (const char *size = std::getenv("BTFT_PARSE_CACHE_SIZE")) {
+        btft::parser::ParseCache::GetInstance().SetCapacity(
+            std::strtoull(size, nullptr, 10)
+        );
+    }
 
+    // btft                 interactive
+    // btft -c 'line...'    runs the given lines
+    // btft script.sh       runs the file
     const btft::ShellRepl repl;
-    return repl.Run();
+    if (argc < 2) {
+        return repl.Run();
+    }
+
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+    const std::string_view first = argv[1];
+    if (first == "-c") {
+        if (argc < 3) {
+            std::cerr << "btft: -c: option requires an argument\n";
+            return 2;
+        }
+        // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+        return repl.RunScript(argv[2]);
+    }
+    return repl.RunFile(std::string(first));
 }
@@ -7,7 +7,6 @@
 #include "ShellParser.h"
 
 // Other
-#include <environment.h>
 #include <any>
 #include <string>
 #include <string_view>
@@ -38,15 +37,16 @@ private:
         using interpreter::CommandNode;
         using interpreter::PipelineNode;
 
-        const bool has_commands = ctx->pipe() != nullptr;
-
-        if (!ctx->assignment().empty()) {
-            const bool make_global = !has_commands;
-            ApplyAssignments(ctx->assignment(), make_global);
+        PipelineNode pipeline;
+        for (ShellParser::AssignmentContext *a : ctx->assignment()) {
+            interpreter::ArgToken value;
+            value.segments.push_back(MakeSegmentFromWord(a->value()->word()));
+            pipeline.AddAssignment(interpreter::AssignmentNode(
+                a->NAME()->getText(), std::move(value)
+            ));
         }
 
-        PipelineNode pipeline;
-        if (has_commands) {
+        if (ctx->pipe() != nullptr) {
             for (const auto &cmd : ParsePipe(ctx->pipe())) {
                 pipeline.AddCommand(cmd);
             }
@@ -55,59 +55,6 @@ private:
         return pipeline;
     }
 
-    static void ApplyAssignments(
-        const std::vector<ShellParser::AssignmentContext *> &assignments,
-        bool make_global
-    ) {
-        auto &env = Environment::GetInstance();
-
-        for (ShellParser::AssignmentContext *a : assignments) {
-            const std::string name = a->NAME()->getText();
-            const auto [text, allow_expansion] =
-                MakeSegmentFromWord(a->value()->word());
-
-            const std::string value =
-                allow_expansion ? ExpandVars(text, env) : text;
-
-            if (make_global) {
-                env.SetGlobal(name, value);
-            } else {
-                env.SetLocal(name, value);
-            }
-        }
-    }
-
-    static std::string ExpandVars(std::string_view s, const Environment &env) {
-        std::string out;
-        out.reserve(s.size());
-
-        for (std::size_t i = 0; i < s.size(); ++i) {
-            if (const char c = s[i]; c != '$') {
-                out.push_back(c);
-                continue;
-            }
-
-            if (i + 1 >= s.size() || !interpreter::IsVarStart(s[i + 1])) {
-                out.push_back('$');
-                continue;
-            }
-
-            std::size_t j = i + 1;
-            while (j < s.size() && interpreter::IsVarChar(s[j])) {
-                ++j;
-            }
-
-            const std::string name(s.substr(i + 1, j - (i + 1)));
-            if (const auto val = env.GetVar(name); val.has_value()) {
-                out += *val;
-            }
-
-            i = j - 1;
-        }
-
-        return out;
-    }
-
     static std::vector<interpreter::CommandNode> ParsePipe(
         ShellParser::PipeContext *ctx
     ) {
@@ -1,31 +1,10 @@
 #include "parser/antlr_support.h"
 #include <string_view>
 #include "ShellLexer.h"
+#include "parser/word_support.h"
 
 namespace btft::parser {
 
-namespace {
-
-template <char Quote>
-    requires(Quote == '\'' || Quote == '"')
-[[nodiscard]] std::string UnescapeQuoted(std::string_view s) {
-    std::string out;
-    out.reserve(s.size());
-    for (std::size_t i = 0; i < s.size(); ++i) {
-        if (s.at(i) == '\\' && i + 1 < s.size()) {
-            if (const char next = s.at(i + 1); next == Quote) {
-                out.push_back(next);
-                ++i;
-                continue;
-            }
-        }
-        out.push_back(s.at(i));
-    }
-    return out;
-}
-
-}  // namespace
-
 std::string DecodeWordToken(const antlr4::Token &token) {
     std::string text = token.getText();
     auto good_quoted = [&text](char q) -> bool {
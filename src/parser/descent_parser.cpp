@@ -0,0 +1,275 @@
+#include "parser/descent_parser.h"
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+#include "parser/word_support.h"
+
+namespace btft::parser {
+
+namespace {
+
+enum class TokenType {
+    kName,
+    kWord,
+    kSingleQuoted,
+    kDoubleQuoted,
+    kAssign,
+    kPipe,
+    kEnd,
+    kError,
+};
+
+struct Token {
+    TokenType type = TokenType::kEnd;
+    std::string_view text;
+    std::size_t start = 0;
+};
+
+bool IsBlank(char c) noexcept {
+    return c == ' ' || c == '\t' || c == '\f';
+}
+
+// ANTLR works on decoded code points; non-ASCII input is left to it
+bool IsAscii(char c) noexcept {
+    return static_cast<unsigned char>(c) < 0x80;
+}
+
+// WORD_CHAR of the grammar, restricted to ASCII
+bool IsWordChar(char c) noexcept {
+    if (!IsAscii(c)) {
+        return false;
+    }
+    return !IsBlank(c) && c != '\r' && c != '\n' && c != '\'' && c != '"' &&
+           c != '=' && c != '|';
+}
+
+bool IsName(std::string_view text) noexcept {
+    if (text.empty() || !interpreter::IsVarStart(text.front())) {
+        return false;
+    }
+    for (const char c : text.substr(1)) {
+        if (!interpreter::IsVarChar(c)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool IsWord(TokenType type) noexcept {
+    return type == TokenType::kName || type == TokenType::kWord ||
+           type == TokenType::kSingleQuoted || type == TokenType::kDoubleQuoted;
+}
+
+// Splits the line into the tokens of Shell.g4; blanks are skipped
+class Lexer final {
+public:
+    explicit Lexer(std::string_view input) : input(input) {
+    }
+
+    Token Next() noexcept {
+        while (pos < input.size() && IsBlank(input[pos])) {
+            ++pos;
+        }
+
+        Token token;
+        token.start = pos;
+        if (pos == input.size()) {
+            return token;
+        }
+
+        const char c = input[pos];
+        if (c == '=' || c == '|') {
+            token.type = c == '=' ? TokenType::kAssign : TokenType::kPipe;
+            token.text = input.substr(pos++, 1);
+            return token;
+        }
+
+        if (c == '\'' || c == '"') {
+            // A quoted word ends at the same quote on the same line, there
+            // are no escapes at this level
+            std::size_t end = pos + 1;
+            while (end < input.size() && input[end] != c &&
+                   input[end] != '\r' && input[end] != '\n' &&
+                   IsAscii(input[end])) {
+                ++end;
+            }
+            if (end == input.size() || input[end] != c) {
+                token.type = TokenType::kError;
+                return token;
+            }
+            token.type = c == '\'' ? TokenType::kSingleQuoted
+                                   : TokenType::kDoubleQuoted;
+            token.text = input.substr(pos, end + 1 - pos);
+            pos = end + 1;
+            return token;
+        }
+
+        if (!IsWordChar(c)) {
+            token.type = TokenType::kError;
+            return token;
+        }
+
+        // Longest match wins; on a tie NAME beats WORD
+        std::size_t end = pos;
+        while (end < input.size() && IsWordChar(input[end])) {
+            ++end;
+        }
+        token.text = input.substr(pos, end - pos);
+        token.type = IsName(token.text) ? TokenType::kName : TokenType::kWord;
+        pos = end;
+        return token;
+    }
+
+    [[nodiscard]] Token Peek() const noexcept {
+        Lexer copy = *this;
+        return copy.Next();
+    }
+
+private:
+    std::string_view input;
+    std::size_t pos = 0;
+};
+
+interpreter::ArgSegment MakeSegment(const Token &token) {
+    const std::string_view body = token.text.substr(1, token.text.size() - 2);
+    switch (token.type) {
+        case TokenType::kSingleQuoted:
+            return interpreter::ArgSegment{
+                .text = UnescapeQuoted<'\''>(body), .allow_expansion = false};
+        case TokenType::kDoubleQuoted:
+            return interpreter::ArgSegment{
+                .text = UnescapeQuoted<'"'>(body), .allow_expansion = true};
+        default:
+            return interpreter::ArgSegment{
+                .text = std::string(token.text), .allow_expansion = true};
+    }
+}
+
+struct Assignment {
+    std::string_view name;
+    Token value;
+};
+
+// One recursive-descent function per grammar rule; each returns false on a
+// syntax error and leaves the rest of the line to the fallback parser
+class Parser final {
+public:
+    explicit Parser(std::string_view input) : lexer(input) {
+        current = lexer.Next();
+    }
+
+    // line : EOF | stmt EOF
+    bool ParseLine() {
+        if (current.type == TokenType::kEnd) {
+            return true;
+        }
+        return ParseStmt() && current.type == TokenType::kEnd;
+    }
+
+    void Build(interpreter::PipelineNode &pipeline) {
+        for (const auto &assignment : assignments) {
+            interpreter::ArgToken value;
+            value.segments.push_back(MakeSegment(assignment.value));
+            pipeline.AddAssignment(interpreter::AssignmentNode(
+                std::string(assignment.name), std::move(value)
+            ));
+        }
+        for (auto &command : commands) {
+            pipeline.AddCommand(std::move(command));
+        }
+    }
+
+private:
+    // stmt : assignment+ pipe? | pipe
+    bool ParseStmt() {
+        while (current.type == TokenType::kName &&
+               lexer.Peek().type == TokenType::kAssign) {
+            if (!ParseAssignment()) {
+                return false;
+            }
+        }
+        if (!assignments.empty() && !IsWord(current.type)) {
+            return true;
+        }
+        return ParsePipe();
+    }
+
+    // assignment : NAME '=' value ; value : word
+    bool ParseAssignment() {
+        const std::string_view name = current.text;
+        Advance();  // NAME
+        Advance();  // '='
+        if (!IsWord(current.type)) {
+            return false;
+        }
+        assignments.push_back(Assignment{.name = name, .value = current});
+        Advance();
+        return true;
+    }
+
+    // pipe : command ('|' command)*
+    bool ParsePipe() {
+        if (!ParseCommand()) {
+            return false;
+        }
+        while (current.type == TokenType::kPipe) {
+            Advance();
+            if (!ParseCommand()) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // command : word+ ; words without blanks in between form one argument
+    bool ParseCommand() {
+        if (!IsWord(current.type)) {
+            return false;
+        }
+
+        std::vector<interpreter::ArgToken> words;
+        interpreter::ArgToken word;
+        std::size_t previous_end = std::string_view::npos;
+        while (IsWord(current.type)) {
+            if (current.start != previous_end && !word.Empty()) {
+                words.push_back(std::move(word));
+                word = interpreter::ArgToken{};
+            }
+            word.segments.push_back(MakeSegment(current));
+            previous_end = current.start + current.text.size();
+            Advance();
+        }
+        words.push_back(std::move(word));
+
+        interpreter::ArgToken name = std::move(words.front());
+        words.erase(words.begin());
+        commands.emplace_back(std::move(name), std::move(words));
+        return true;
+    }
+
+    void Advance() noexcept {
+        current = lexer.Next();
+    }
+
+    Lexer lexer;
+    Token current;
+    std::vector<Assignment> assignments;
+    std::vector<interpreter::CommandNode> commands;
+};
+
+}  // namespace
+
+ParseResult DescentParser::Parse(std::string_view input) const {
+    Parser parser(input);
+    if (!parser.ParseLine()) {
+        return fallback->Parse(input);
+    }
+
+    interpreter::PipelineNode pipeline;
+    parser.Build(pipeline);
+    return ParseResult::Ok(std::move(pipeline));
+}
+
+}  // namespace btft::parser
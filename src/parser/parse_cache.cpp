@@ -0,0 +1,65 @@
+#include "parser/parse_cache.h"
+
+namespace btft::parser {
+
+std::shared_ptr<const ParseResult> ParseCache::Parse(
+    std::string_view line,
+    const IParser &parser
+) {
+    {
+        const std::lock_guard lock(mutex);
+        if (const auto it = index.find(line); it != index.end()) {
+            ++hits;
+            entries.splice(entries.begin(), entries, it->second);
+            return it->second->second;
+        }
+        ++misses;
+        if (capacity == 0) {
+            return std::make_shared<const ParseResult>(parser.Parse(line));
+        }
+    }
+
+    // Parsed without the lock, ANTLR may take a while on a bad line
+    auto result = std::make_shared<const ParseResult>(parser.Parse(line));
+
+    const std::lock_guard lock(mutex);
+    if (capacity == 0 || index.contains(line)) {
+        return result;
+    }
+    entries.emplace_front(std::string(line), result);
+    index.emplace(entries.front().first, entries.begin());
+    Shrink();
+    return result;
+}
+
+void ParseCache::SetCapacity(std::size_t new_capacity) {
+    const std::lock_guard lock(mutex);
+    capacity = new_capacity;
+    Shrink();
+}
+
+void ParseCache::Clear() {
+    const std::lock_guard lock(mutex);
+    index.clear();
+    entries.clear();
+    hits = 0;
+    misses = 0;
+}
+
+ParseCache::Stats ParseCache::GetStats() {
+    const std::lock_guard lock(mutex);
+    return Stats{
+        .hits = hits,
+        .misses = misses,
+        .size = entries.size(),
+        .capacity = capacity};
+}
+
+void ParseCache::Shrink() {
+    while (entries.size() > capacity) {
+        index.erase(entries.back().first);
+        entries.pop_back();
+    }
+}
+
+}  // namespace btft::parser
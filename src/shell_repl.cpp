@@ -4,16 +4,84 @@
 #include <antlr4-runtime.h>
 
 // Other
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
 #include <iostream>
 #include <memory>
+#include <optional>
 #include <string>
 #include "environment.h"
 #include "executor/executor.h"
+#include "executor/scoped_fd.h"
 #include "parser/antlr_parser.h"
+#include "parser/descent_parser.h"
+#include "parser/parse_cache.h"
 
 namespace btft {
 
-ShellRepl::ShellRepl() : parser(std::make_unique<parser::AntlrParser>()) {
+namespace {
+
+using interpreter::executor::ScopedFd;
+
+// Reads the whole file; errno is set if it returns nullopt. Scripts are
+// read rather than mapped: lines are parsed straight from the text for the
+// whole run, and a mapped file truncated meanwhile would raise SIGBUS there
+std::optional<std::string> LoadScript(const std::string &path) {
+    const ScopedFd fd(::open(path.c_str(), O_RDONLY | O_CLOEXEC));
+    if (!fd.IsValid()) {
+        return std::nullopt;
+    }
+
+    std::string script;
+    // Regular files are read in one call sized to the file, with a spare
+    // byte to see the end; anything else in fixed blocks
+    std::size_t expected = 0;
+    struct stat file_stat {};
+    if (::fstat(fd.Get(), &file_stat) == 0 && S_ISREG(file_stat.st_mode)) {
+        expected = static_cast<std::size_t>(file_stat.st_size) + 1;
+    }
+
+    constexpr std::size_t kReadSize = 256 * 1024;
+    while (true) {
+        const std::size_t done = script.size();
+        const std::size_t want = done < expected ? expected - done : kReadSize;
+        script.resize(done + want);
+        const ssize_t count = ::read(fd.Get(), script.data() + done, want);
+        if (count < 0 && errno == EINTR) {
+            script.resize(done);
+            continue;
+        }
+        if (count < 0) {
+            return std::nullopt;
+        }
+        script.resize(done + static_cast<std::size_t>(count));
+        if (count == 0) {
+            return script;
+        }
+    }
+}
+
+// Whether fd 2 ends up in the same file or pipe as fd 1 (`2>&1`, or both
+// on one terminal)
+bool StderrSharesStdout() {
+    struct stat out_stat {};
+    struct stat err_stat {};
+    return ::fstat(STDOUT_FILENO, &out_stat) == 0 &&
+           ::fstat(STDERR_FILENO, &err_stat) == 0 &&
+           out_stat.st_dev == err_stat.st_dev &&
+           out_stat.st_ino == err_stat.st_ino;
+}
+
+}  // namespace
+
+// Lines the hand-written parser can't handle get ANTLR's diagnostics
+ShellRepl::ShellRepl()
+    : parser(std::make_unique<parser::DescentParser>(
+          std::make_unique<parser::AntlrParser>()
+      )) {
 }
 
 interpreter::ExecutionResult ShellRepl::ProcessLine(std::string_view input
@@ -24,22 +92,26 @@ interpreter::ExecutionResult ShellRepl::ProcessLine(std::string_view input
     auto &env = Environment::GetInstance();
     env.ClearLocal();
 
-    const parser::ParseResult parsed = parser->Parse(input);
-    if (!parsed.IsOk()) {
+    // Parsing has no side effects, a line run before is taken from the cache
+    const std::shared_ptr<const parser::ParseResult> parsed =
+        parser::ParseCache::GetInstance().Parse(input, *parser);
+    if (!parsed->IsOk()) {
         env.ClearLocal();
         ExecutionResult res;
         res.exit_code = 1;
-        res.error_message = parsed.error_message;
+        res.error_message = parsed->error_message;
         return res;
     }
 
     ExecutionResult result{};
-    if (parsed.pipeline.has_value()) {
-        const PipelineNode &pipeline = parsed.pipeline.value();
-        if (!pipeline.Empty()) {
-            result =
-                interpreter::executor::ExecutePipeline(pipeline.GetCommands());
-        }
+    const PipelineNode &pipeline = parsed->pipeline.value();
+    interpreter::executor::ApplyAssignments(pipeline);
+    if (pipeline.Size() == 1) {
+        result = interpreter::executor::ExecuteCommand(
+            pipeline.GetCommands().front()
+        );
+    } else if (!pipeline.Empty()) {
+        result = interpreter::executor::ExecutePipeline(pipeline.GetCommands());
     }
 
     env.ClearLocal();
@@ -54,7 +126,7 @@ int ShellRepl::Run() const {
 
     while (!execution_result.should_exit) {
         PrintPrompt();
-        if (!std::getline(std::cin, input)) {
+        if (!interpreter::executor::ReadInputLine(input)) {
             break;
         }
 
@@ -63,6 +135,7 @@ int ShellRepl::Run() const {
         }
 
         execution_result = ProcessLine(input);
+        interpreter::executor::FlushOutput();
         if (!execution_result.error_message.empty()) {
             std::cout << execution_result.error_message << "\n";
             std::cout << std::flush;
@@ -73,4 +146,48 @@ int ShellRepl::Run() const {
     return execution_result.exit_code;
 }
 
+int ShellRepl::RunScript(std::string_view script) const {
+    using interpreter::ExecutionResult;
+
+    // Diagnostics go to stderr unbuffered; when both streams share a file,
+    // stdout is flushed after every line so they stay in order
+    const bool flush_each_line = StderrSharesStdout();
+
+    ExecutionResult execution_result{};
+    while (!script.empty() && !execution_result.should_exit) {
+        const std::size_t end = script.find('\n');
+        const std::string_view line = script.substr(0, end);
+        script.remove_prefix(
+            end == std::string_view::npos ? script.size() : end + 1
+        );
+
+        // Comments, the #! line among them, are not commands
+        if (IsBlank(line) || IsComment(line)) {
+            continue;
+        }
+
+        execution_result = ProcessLine(line);
+        if (!execution_result.error_message.empty()) {
+            // Command output bypasses std::cout, keep the order
+            interpreter::executor::FlushOutput();
+            std::cout << execution_result.error_message << "\n" << std::flush;
+        } else if (flush_each_line) {
+            interpreter::executor::FlushOutput();
+        }
+    }
+
+    // Otherwise output stays buffered across lines and goes out in blocks
+    interpreter::executor::FlushOutput();
+    return execution_result.exit_code;
+}
+
+int ShellRepl::RunFile(const std::string &path) const {
+    const std::optional<std::string> script = LoadScript(path);
+    if (!script) {
+        std::cerr << "btft: " << path << ": " << std::strerror(errno) << "\n";
+        return 127;
+    }
+    return RunScript(*script);
+}
+
 }  // namespace btft
@@ -45,8 +45,19 @@ fi
 
 echo "Running test: $TEST_NAME"
 
-# Run the test by feeding input to btft and capturing output
-"$BTFT_EXEC" < "$TEST_INPUT_FILE" > "$TEST_OUTPUT_FILE" 2>&1
+# Run the test by feeding input to btft and capturing output; *_script
+# tests hand the input file to btft as a script instead, *_command tests
+# pass its contents to btft -c and record the exit status
+if [[ "$TEST_NAME" == *_script ]]; then
+    "$BTFT_EXEC" "$TEST_INPUT_FILE" > "$TEST_OUTPUT_FILE" 2>&1
+elif [[ "$TEST_NAME" == *_command ]]; then
+    STATUS=0
+    "$BTFT_EXEC" -c "$(cat "$TEST_INPUT_FILE")" > "$TEST_OUTPUT_FILE" 2>&1 \
+        || STATUS=$?
+    echo "exit status: $STATUS" >> "$TEST_OUTPUT_FILE"
+else
+    "$BTFT_EXEC" < "$TEST_INPUT_FILE" > "$TEST_OUTPUT_FILE" 2>&1
+fi
 
 # Compare output with expected result
 if diff -u "$TEST_EXPECTED_FILE" "$TEST_OUTPUT_FILE"; then
@@ -1,6 +1,6 @@
 #!/bin/bash
 
-# Run all integration tests
+# Run the unit tests and all integration tests
 
 # Get the absolute path to the script directory
 SCRIPT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
@@ -11,8 +11,19 @@ TEST_INTEGRATION_DIR="$SCRIPT_DIR/integration"
 echo "Building btft executable..."
 mkdir -p "$BUILD_DIR"
 cd "$BUILD_DIR"
-cmake "$PROJECT_ROOT" -DBUILD_TESTS=OFF
+cmake "$PROJECT_ROOT" -DBUILD_TESTS=ON
 make -j$(nproc)
+
+PASSED=0
+FAILED=0
+
+echo "Running unit tests..."
+if ctest --output-on-failure; then
+    ((PASSED++))
+else
+    ((FAILED++))
+fi
+
 cd "$TEST_INTEGRATION_DIR"
 
 echo "Running integration tests..."
@@ -23,14 +34,20 @@ TESTS=(
     "cat_file"
     "pwd_test"
     "wc_test"
+    "wc_multi_test"
     "env_test"
     "external_env_test"
     "unknown_command_test"
+    "external_pipe_test"
+    "hash_test"
+    "stats_test"
+    "batch_script"
+    "pipeline_fusion_test"
+    "mixed_output_script"
+    "comment_script"
+    "inline_command"
 )
 
-PASSED=0
-FAILED=0
-
 pwd
 
 for test_name in "${TESTS[@]}"; do
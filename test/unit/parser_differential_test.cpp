@@ -0,0 +1,179 @@
+// Differential test: DescentParser must accept exactly the lines AntlrParser
+// accepts and produce the same PipelineNode.
+// Exits with a non-zero status and prints the first offending lines.
+
+#include <algorithm>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "common.h"
+#include "parser/antlr_parser.h"
+#include "parser/descent_parser.h"
+
+namespace {
+
+using btft::interpreter::ArgToken;
+using btft::interpreter::PipelineNode;
+using btft::parser::AntlrParser;
+using btft::parser::DescentParser;
+using btft::parser::IParser;
+using btft::parser::ParseResult;
+
+constexpr std::string_view kFallbackMessage = "<fallback>";
+
+// Stands in for ANTLR behind DescentParser, to see which lines it rejects
+class RejectingParser final : public IParser {
+public:
+    [[nodiscard]] ParseResult Parse(std::string_view /*input*/) const override {
+        return ParseResult::Error(std::string(kFallbackMessage));
+    }
+};
+
+bool SameToken(const ArgToken &lhs, const ArgToken &rhs) {
+    return std::ranges::equal(
+        lhs.segments, rhs.segments,
+        [](const auto &l, const auto &r) {
+            return l.text == r.text && l.allow_expansion == r.allow_expansion;
+        }
+    );
+}
+
+bool SamePipeline(const PipelineNode &lhs, const PipelineNode &rhs) {
+    const bool same_assignments = std::ranges::equal(
+        lhs.GetAssignments(), rhs.GetAssignments(),
+        [](const auto &l, const auto &r) {
+            return l.GetName() == r.GetName() &&
+                   SameToken(l.GetValue(), r.GetValue());
+        }
+    );
+    return same_assignments && std::ranges::equal(
+        lhs.GetCommands(), rhs.GetCommands(),
+        [](const auto &l, const auto &r) {
+            return SameToken(l.GetName(), r.GetName()) &&
+                   std::ranges::equal(l.GetArgs(), r.GetArgs(), SameToken);
+        }
+    );
+}
+
+bool IsAscii(std::string_view line) {
+    return std::ranges::all_of(line, [](char c) {
+        return static_cast<unsigned char>(c) < 0x80;
+    });
+}
+
+// Returns an empty string if both parsers agree on `line`
+std::string Compare(
+    const IParser &descent,
+    const IParser &antlr,
+    std::string_view line
+) {
+    const ParseResult fast = descent.Parse(line);
+    const ParseResult reference = antlr.Parse(line);
+
+    if (!fast.IsOk()) {
+        if (reference.IsOk() && IsAscii(line)) {
+            return "rejected a line ANTLR accepts";
+        }
+        return {};
+    }
+    if (!reference.IsOk()) {
+        return "accepted a line ANTLR rejects (" + reference.error_message +
+               ")";
+    }
+    if (!SamePipeline(*fast.pipeline, *reference.pipeline)) {
+        return "built a different pipeline";
+    }
+    return {};
+}
+
+std::vector<std::string> FixedCorpus() {
+    return {
+        "",
+        "   ",
+        "echo hello",
+        "echo   a\tb\fc",
+        "echo a\"b\"'c' d",
+        "echo \"$x and $a\" '$x'",
+        "echo \"q\\\"x",
+        "echo 'a\\'",
+        "x=1",
+        "x = 2",
+        "x=1 y=2",
+        "x=$a echo $x",
+        "x=\"a\"b",
+        "x='$a' cat",
+        "a=1 b_1=$a echo",
+        "echo a=b",
+        "a=b=c",
+        "x=1 | echo",
+        "echo |",
+        "| echo",
+        "echo || wc",
+        "cat|wc",
+        "echo a|b",
+        "echo hi | cat | wc",
+        "echo 'unterminated",
+        "echo \"unterminated",
+        "echo \r",
+        "echo \xc3\xa9",
+        "=",
+        "|",
+        "'' \"\"",
+        "echo ''\"\"x",
+        "-n -e",
+        "x=",
+        "x=|",
+    };
+}
+
+// Random lines built from grammar fragments, valid and invalid alike
+std::vector<std::string> RandomCorpus(std::size_t count) {
+    const std::vector<std::string> fragments = {
+        "echo", "a",   "b_1",  "x",    "cat", "wc",   "-n",  "1x",
+        "$x",   "a$b", "=",    "=",    "|",   " ",    " ",   " ",
+        "\t",   "'",   "\"",   "'q w'", "\"d $x\"", "''", "\"\"", "\\",
+        "/tmp", "a.b", "\\\"", "x=1",
+    };
+
+    std::mt19937 rng(2024);
+    std::vector<std::string> lines;
+    lines.reserve(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        std::string line;
+        const std::size_t length = 1 + rng() % 10;
+        for (std::size_t j = 0; j < length; ++j) {
+            line += fragments[rng() % fragments.size()];
+        }
+        lines.push_back(std::move(line));
+    }
+    return lines;
+}
+
+}  // namespace
+
+int main() {
+    const AntlrParser antlr;
+    const DescentParser descent(std::make_unique<RejectingParser>());
+
+    std::vector<std::string> lines = FixedCorpus();
+    for (auto &line : RandomCorpus(20000)) {
+        lines.push_back(std::move(line));
+    }
+
+    std::size_t failures = 0;
+    for (const auto &line : lines) {
+        const std::string problem = Compare(descent, antlr, line);
+        if (problem.empty()) {
+            continue;
+        }
+        if (++failures <= 20) {
+            std::cout << "DescentParser " << problem << ": [" << line << "]\n";
+        }
+    }
+
+    std::cout << lines.size() << " lines, " << failures << " mismatches\n";
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,139 @@
+// Checks every CountStats kernel this CPU can run against the scalar
+// reference: random buffers of odd lengths around the 16/32/64-byte vector
+// widths, all-whitespace and all-word buffers, non-ASCII bytes, and streams
+// split into two pieces with the word state carried across.
+// Exits with a non-zero status and prints the first offending cases.
+
+#include <cstddef>
+#include <iostream>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "executor/commands/wc_stats.h"
+
+namespace {
+
+using btft::interpreter::executor::commands::AvailableCountKernels;
+using btft::interpreter::executor::commands::CountKernel;
+using btft::interpreter::executor::commands::CountStatsScalar;
+using btft::interpreter::executor::commands::TextStats;
+
+struct Counted {
+    TextStats stats;
+    bool in_word = false;
+};
+
+bool operator==(const Counted &lhs, const Counted &rhs) {
+    return lhs.stats.lines == rhs.stats.lines &&
+           lhs.stats.words == rhs.stats.words &&
+           lhs.stats.bytes == rhs.stats.bytes && lhs.in_word == rhs.in_word;
+}
+
+std::ostream &operator<<(std::ostream &out, const Counted &counted) {
+    return out << counted.stats.lines << " " << counted.stats.words << " "
+               << counted.stats.bytes << (counted.in_word ? " in_word" : "");
+}
+
+// Counts `text` as two consecutive pieces split at `split`
+Counted Count(
+    TextStats (*count)(std::string_view, bool &),
+    std::string_view text,
+    std::size_t split,
+    bool in_word
+) {
+    Counted counted;
+    counted.in_word = in_word;
+    counted.stats += count(text.substr(0, split), counted.in_word);
+    counted.stats += count(text.substr(split), counted.in_word);
+    return counted;
+}
+
+// Bytes drawn from `alphabet`
+std::string RandomText(
+    std::mt19937 &rng,
+    std::size_t size,
+    std::string_view alphabet
+) {
+    std::string text(size, '\0');
+    for (char &c : text) {
+        c = alphabet[rng() % alphabet.size()];
+    }
+    return text;
+}
+
+// Any byte value, whitespace made common enough to form short words
+std::string RandomBytes(std::mt19937 &rng, std::size_t size) {
+    std::string text(size, '\0');
+    for (char &c : text) {
+        const unsigned value = rng() % 512;
+        c = static_cast<char>(value < 256 ? value : " \t\n\v\f\r"[value % 6]);
+    }
+    return text;
+}
+
+std::vector<std::string> Corpus() {
+    constexpr std::string_view kWhitespace = " \t\n\v\f\r";
+    constexpr std::string_view kWordBytes = "ab\x08\x0e\x1f!\x7f\x80\xa0\xff";
+    constexpr std::string_view kMixed = "a \n\tb\xc3\xa9\r\x0b\x0c\x85\xa0";
+
+    std::mt19937 rng(2024);
+    std::vector<std::string> corpus;
+    // Every length up to a few blocks, then odd lengths further out
+    for (std::size_t size = 0; size <= 300; ++size) {
+        corpus.push_back(RandomText(rng, size, kMixed));
+        corpus.push_back(RandomBytes(rng, size));
+    }
+    for (std::size_t size = 301; size < 20000; size += 2 * (rng() % 997) + 1) {
+        corpus.push_back(RandomText(rng, size, kMixed));
+        corpus.push_back(RandomBytes(rng, size));
+    }
+    for (const std::size_t size : {1, 15, 31, 63, 64, 65, 127, 129, 1001}) {
+        corpus.push_back(RandomText(rng, size, kWhitespace));
+        corpus.push_back(RandomText(rng, size, kWordBytes));
+        corpus.emplace_back(size, '\n');
+        corpus.emplace_back(size, '\xff');
+    }
+    return corpus;
+}
+
+}  // namespace
+
+int main() {
+    const std::vector<CountKernel> kernels = AvailableCountKernels();
+    const std::vector<std::string> corpus = Corpus();
+
+    std::mt19937 rng(7);
+    std::size_t cases = 0;
+    std::size_t failures = 0;
+    for (const auto &text : corpus) {
+        const std::size_t split = text.empty() ? 0 : rng() % (text.size() + 1);
+        for (const bool in_word : {false, true}) {
+            const Counted expected =
+                Count(CountStatsScalar, text, text.size(), in_word);
+            for (const CountKernel &kernel : kernels) {
+                for (const std::size_t at : {text.size(), split}) {
+                    ++cases;
+                    const Counted actual =
+                        Count(kernel.count, text, at, in_word);
+                    if (actual == expected) {
+                        continue;
+                    }
+                    if (++failures <= 20) {
+                        std::cout << kernel.name << ": " << text.size()
+                                  << " bytes split at " << at << ": got "
+                                  << actual << ", expected " << expected
+                                  << "\n";
+                    }
+                }
+            }
+        }
+    }
+
+    std::cout << "kernels:";
+    for (const CountKernel &kernel : kernels) {
+        std::cout << " " << kernel.name;
+    }
+    std::cout << "; " << cases << " cases, " << failures << " mismatches\n";
+    return failures == 0 ? 0 : 1;
+}